@@ -89,6 +89,7 @@ typedef enum {
     MSC_TYPE_MAP,
     MSC_TYPE_NULL,
     MSC_TYPE_STRING,
+    MSC_TYPE_BUFFER,
 
     MSC_TYPE_UNKNOWN
 } MSCType;
@@ -104,7 +105,10 @@ typedef bool (*MSCErrorHandler)(MVM *vm, MSCError type, const char *module_name,
 typedef enum InterpretResult {
     RESULT_COMPILATION_ERROR,
     RESULT_RUNTIME_ERROR,
-    RESULT_SUCCESS
+    RESULT_SUCCESS,
+    // The fuel ran out and the djuru waits in the scheduler. See
+    // [MSCSetFuel].
+    RESULT_SUSPENDED
 } MSCInterpretResult;
 typedef struct {
     // The callback invoked when the foreign object is created.
@@ -128,6 +132,10 @@ typedef MSCExternClassMethods (*MSCBindExternClassFn)(
 
 typedef struct {
 
+    // The allocator used for all memory of the VM. [MSCPostEvent] calls it from
+    // the posting threads too, so a custom one must be thread-safe if events
+    // are posted from other threads. The default one, `realloc` and `free`,
+    // is.
     MSCReallocator reallocateFn;
     MSCResolveModuleFn resolveModuleFn;
     MSCLoadModuleFn loadModuleFn;
@@ -145,6 +153,23 @@ typedef struct {
     // If zero, defaults to 10MB.
     size_t initialHeapSize;
     int heapGrowthPercent;
+
+    // The number of worker threads used to sort and reduce large lists of
+    // numbers or strings, besides the thread running the VM. They are started
+    // the first time they are needed.
+    //
+    // If zero, those run on the calling thread only.
+    int workerThreads;
+    // The number of elements from which a list is worth splitting between the
+    // worker threads.
+    //
+    // If zero, defaults to 65536.
+    uint32_t parallelThreshold;
+
+    // What a djuru does when the fuel given with [MSCSetFuel] runs out. If
+    // false, it aborts with an error. If true, it is suspended in the
+    // scheduler, and goes on once there is fuel again and the scheduler runs.
+    bool fuelSuspends;
     void *userData;
 } MSCConfig;
 
@@ -204,6 +229,70 @@ MSC_API MSCHandle *MSCMakeCallHandle(MVM *vm, const char *signature);
 // After this returns, you can access the return value from slot 0 on the stack.
 MSC_API MSCInterpretResult MSCCall(MVM *vm, MSCHandle *method);
 
+// Runs the djurus waiting in the scheduler of [vm] on the calling thread, one
+// at a time, until each of them suspends again or finishes. Djurus wait there
+// after Djuru.bila(), Djuru.sunogo() or makono(), including the one running
+// the module when it sleeps.
+//
+// Resumes at most [budget] djurus and never blocks. If [budget] is zero or
+// less, runs until no djuru is left waiting, sleeping the thread while only
+// sleeping djurus are left.
+//
+// Returns the number of djurus still waiting. An error in a djuru is reported
+// and only ends that djuru.
+MSC_API int MSCRunScheduler(MVM *vm, int budget);
+
+// Queues an event for the function held by [handle], with a copy of the
+// [length] bytes at [bytes] as its argument, a Uint8Walan.
+//
+// Unlike the rest of the API, this may be called from any thread, and it
+// neither blocks nor takes a lock. The thread running [vm] takes the events in
+// batches each time [MSCRunScheduler] looks for djurus to resume, and calls
+// each function in a new djuru, in the order the events were posted. A
+// scheduler waiting for a descriptor, an operation or a sleeping djuru is
+// woken up by them. Built without MSC_OPT_THREADS, as on Windows and
+// Emscripten, it must be called from the thread running [vm] instead.
+//
+// [handle] must stay alive until its events are dispatched, and the
+// configured [reallocateFn] must be safe to call from the posting threads.
+// Returns false if [handle] does not hold a function taking at most one
+// parameter, or if the event could not be allocated.
+MSC_API bool MSCPostEvent(MVM *vm, MSCHandle *handle, const void *bytes, size_t length);
+
+// Makes the djuru [vm] is running abort with the error "Djuru was
+// interrupted." at its next loop back-edge or call, which an `ake` block can
+// catch like any other. If nothing is running, the next script to run is
+// interrupted instead.
+//
+// Built with MSC_OPT_THREADS, the default except on Windows and Emscripten,
+// this may be called from any thread, including from a signal handler.
+// Otherwise it must be called from the thread running [vm], for example from
+// a foreign method.
+MSC_API void MSCInterrupt(MVM *vm);
+
+// Gives each following [MSCInterpret] and [MSCCall] [milliseconds] of wall
+// clock time to return, or no limit if it is zero. A call that runs out
+// aborts its djuru with the error "Deadline exceeded." at its next loop
+// back-edge or call, and again at each one after that until the call returns,
+// so an `ake` block catching the error cannot keep it running.
+MSC_API void MSCSetTimeout(MVM *vm, double milliseconds);
+
+// Meters the work done by [vm] with [fuel] units of fuel. Each loop back-edge
+// and each call into a function or method costs one, so the same script with
+// the same fuel always stops at the same point.
+//
+// A djuru reaching one of them with no fuel left aborts with the error "Out of
+// fuel.", or is suspended if [MSCConfig.fuelSuspends] is true. The call from
+// the host running it then returns [RESULT_SUSPENDED] and the djuru waits in
+// the scheduler. [MSCRunScheduler] stops resuming djurus while there is no
+// fuel, so it can be given a slice of fuel at a time.
+//
+// A negative [fuel] turns metering off, which is the default.
+MSC_API void MSCSetFuel(MVM *vm, int64_t fuel);
+
+// Returns the fuel [vm] has left, or -1 if metering is off.
+MSC_API int64_t MSCGetFuel(MVM *vm);
+
 // Releases the reference stored in [handle]. After calling this, [handle] can
 // no longer be used.
 MSC_API void MSCReleaseHandle(MVM *vm, MSCHandle *handle);
@@ -276,6 +365,15 @@ MSC_API bool MSCGetSlotBool(MVM *vm, int slot);
 // It is an error to call this if the slot does not contain a string.
 MSC_API const char *MSCGetSlotBytes(MVM *vm, int slot, int *length);
 
+// Reads a byte buffer, a Uint8Walan, from [slot].
+//
+// Returns a pointer to its first byte and fills [length] with the number of
+// bytes. The host may read and write them in place. The memory is owned by
+// Mosc, so the pointer cannot be kept after the function returns.
+//
+// It is an error to call this if the slot does not contain a Uint8Walan.
+MSC_API uint8_t *MSCGetSlotBuffer(MVM *vm, int slot, size_t *length);
+
 // Reads a number from [slot].
 //
 // It is an error to call this if the slot does not contain a number.
@@ -312,6 +410,10 @@ MSC_API void MSCSetSlotBool(MVM *vm, int slot, bool value);
 // memory used by them after this is called.
 MSC_API void MSCSetSlotBytes(MVM *vm, int slot, const char *bytes, size_t length);
 
+// Stores a new zero-filled Uint8Walan of [length] bytes in [slot], and returns
+// a pointer to its bytes so that the host can fill them.
+MSC_API uint8_t *MSCSetSlotNewBuffer(MVM *vm, int slot, size_t length);
+
 // Stores the numeric [value] in [slot].
 MSC_API void MSCSetSlotDouble(MVM *vm, int slot, double value);
 
@@ -8,6 +8,7 @@
 #include "../runtime/debuger.h"
 #include "core/core.msc.inc"
 #include "../memory/Value.h"
+#include "../helpers/Number.h"
 
 
 #include <float.h>
@@ -180,6 +181,16 @@ DEF_PRIMITIVE(djuru_try1) {
     return false;
 }
 
+// Puts [djuru], which yielded with nothing to return to, back at the end of the
+// ready queue if the scheduler is running it, so the other djurus run first.
+static void yieldToScheduler(MVM *vm, Djuru *djuru) {
+    if (!vm->scheduler.running) return;
+
+    MSCPushRoot(vm->gc, (Object *) djuru);
+    MSCScheduleReady(vm, djuru, NULL_VAL);
+    MSCPopRoot(vm->gc);
+}
+
 DEF_PRIMITIVE(djuru_yield) {
     Djuru *current = vm->djuru;
     vm->djuru = current->caller;
@@ -191,6 +202,8 @@ DEF_PRIMITIVE(djuru_yield) {
     if (vm->djuru != NULL) {
         // Make the caller's run method return null.
         vm->djuru->stackTop[-1] = NULL_VAL;
+    } else {
+        yieldToScheduler(vm, current);
     }
 
     return false;
@@ -213,8 +226,81 @@ DEF_PRIMITIVE(djuru_yield1) {
         // class and the value) and we only need one slot for the result, discard
         // the other slot now.
         current->stackTop--;
+    } else if (vm->scheduler.running) {
+        current->stackTop--;
+        yieldToScheduler(vm, current);
+    }
+
+    return false;
+}
+
+// Whether [djuru] has not run yet.
+static bool djuruIsNew(Djuru *djuru) {
+    return djuru->numOfFrames == 1 &&
+           djuru->frames[0].ip == djuru->frames[0].closure->fn->code.data;
+}
+
+DEF_PRIMITIVE(djuru_spawn) {
+    if (!validateFn(vm, args[1], "Argument")) return false;
+
+    Closure *closure = AS_CLOSURE(args[1]);
+    if (closure->fn->arity > 1) {
+        RETURN_ERROR("Function cannot take more than one parameter.");
+    }
+
+    Djuru *djuru = MSCDjuruFrom(vm, closure);
+    MSCPushRoot(vm->gc, (Object *) djuru);
+    MSCScheduleReady(vm, djuru, NULL_VAL);
+    MSCPopRoot(vm->gc);
+    RETURN_OBJ(djuru);
+}
+
+DEF_PRIMITIVE(djuru_schedule) {
+    Djuru *djuru = AS_DJURU(args[0]);
+    if (MSCHasError(djuru)) RETURN_ERROR("Cannot schedule an aborted djuru.");
+    if (!djuruIsNew(djuru) || djuru->caller != NULL) {
+        RETURN_ERROR("Djuru has already been started.");
+    }
+
+    if (!djuru->scheduled) MSCScheduleReady(vm, djuru, NULL_VAL);
+    RETURN_OBJ(djuru);
+}
+
+DEF_PRIMITIVE(djuru_sleep) {
+    if (!validateNum(vm, args[1], "Milliseconds")) return false;
+
+    // Djuru.sunogo(ms) has two arguments and only needs one slot for its
+    // result, so discard the other slot now.
+    Djuru *current = vm->djuru;
+    current->stackTop--;
+    current->stackTop[-1] = NULL_VAL;
+    MSCScheduleSleep(vm, current, AS_NUM(args[1]));
+
+    // Let the scheduler run something else.
+    vm->djuru = NULL;
+    vm->apiStack = NULL;
+    return false;
+}
+
+DEF_PRIMITIVE(djuru_join) {
+    Djuru *djuru = AS_DJURU(args[0]);
+    if (MSCHasError(djuru)) RETURN_NULL;
+
+    // A finished djuru keeps its result in its first slot.
+    if (djuru->numOfFrames == 0) RETURN_VAL(djuru->stack[0]);
+
+    for (Djuru *running = vm->djuru; running != NULL; running = running->caller) {
+        if (running == djuru) RETURN_ERROR("A djuru cannot wait for itself.");
+    }
+
+    // Start it if nothing did yet.
+    if (djuruIsNew(djuru) && djuru->caller == NULL && !djuru->scheduled) {
+        MSCScheduleReady(vm, djuru, NULL_VAL);
     }
 
+    MSCScheduleJoin(vm, vm->djuru, djuru);
+    vm->djuru = NULL;
+    vm->apiStack = NULL;
     return false;
 }
 
@@ -322,262 +408,1968 @@ DEF_PRIMITIVE(list_addAllCore) {
     for (int i = 0; i < other->elements.count; i++) {
         MSCWriteValueBuffer(vm, &AS_LIST(args[0])->elements, other->elements.data[i]);
     }
-    // Return the list.
-    RETURN_VAL(args[0]);
-}
+    // Return the list.
+    RETURN_VAL(args[0]);
+}
+
+DEF_PRIMITIVE(list_clear) {
+    MSCFreeValueBuffer(vm, &AS_LIST(args[0])->elements);
+    RETURN_NULL;
+}
+
+DEF_PRIMITIVE(list_count) {
+    RETURN_NUM(AS_LIST(args[0])->elements.count);
+}
+
+DEF_PRIMITIVE(list_insert) {
+    List *list = AS_LIST(args[0]);
+
+    // count + 1 here so you can "insert" at the very end.
+    uint32_t index = validateIndex(vm, args[1], (uint32_t) list->elements.count + 1, "Index");
+    if (index == UINT32_MAX) return false;
+
+    MSCListInsert(list, vm, args[2], index);
+    RETURN_VAL(args[2]);
+}
+
+DEF_PRIMITIVE(list_iterate) {
+    List *list = AS_LIST(args[0]);
+    if (!validateInt(vm, args[2], "Step")) return false;
+    int32_t step = (int32_t) AS_NUM(args[2]);
+
+    // If we're starting the iteration, return the first index.
+    if (IS_NULL(args[1])) {
+        if (list->elements.count == 0) RETURN_FALSE;
+
+        if (step > 0) RETURN_NUM(0);
+        else
+            RETURN_NUM(list->elements.count - 1);
+    }
+
+    if (!validateInt(vm, args[1], "Iterator")) return false;
+
+    // Stop if we're out of bounds.
+    double index = AS_NUM(args[1]);
+    // double absIndex = step > 0 ? index: -index;
+    if ((step > 0 && (index < 0 || index >= list->elements.count - 1)) || (step < 0 && (index < 1 || index > list->elements.count - 1))) RETURN_FALSE;
+
+    // Otherwise, move to the next index.
+    RETURN_NUM(index + step);
+}
+
+DEF_PRIMITIVE(list_iteratorValue) {
+    List *list = AS_LIST(args[0]);
+    uint32_t index = validateIndex(vm, args[1], (uint32_t) list->elements.count, "Iterator");
+    if (index == UINT32_MAX) return false;
+    RETURN_VAL(list->elements.data[index]);
+}
+
+DEF_PRIMITIVE(list_removeAt) {
+    List *list = AS_LIST(args[0]);
+    uint32_t index = validateIndex(vm, args[1], (uint32_t) list->elements.count, "Index");
+    if (index == UINT32_MAX) return false;
+
+    RETURN_VAL(MSCListRemoveAt(list, vm, index));
+}
+
+DEF_PRIMITIVE(list_removeValue) {
+    List *list = AS_LIST(args[0]);
+    int index = MSCListIndexOf(list, vm, args[1]);
+    if (index == -1) RETURN_NULL;
+    RETURN_VAL(MSCListRemoveAt(list, vm, index));
+}
+
+DEF_PRIMITIVE(list_indexOf) {
+    List *list = AS_LIST(args[0]);
+    RETURN_NUM(MSCListIndexOf(list, vm, args[1]));
+}
+
+DEF_PRIMITIVE(list_swap) {
+    List *list = AS_LIST(args[0]);
+    uint32_t indexA = validateIndex(vm, args[1], (uint32_t) list->elements.count, "Index 0");
+    if (indexA == UINT32_MAX) return false;
+    uint32_t indexB = validateIndex(vm, args[2], (uint32_t) list->elements.count, "Index 1");
+    if (indexB == UINT32_MAX) return false;
+
+    Value a = list->elements.data[indexA];
+    list->elements.data[indexA] = list->elements.data[indexB];
+    list->elements.data[indexB] = a;
+
+    RETURN_NULL;
+}
+
+// Defines [name] as an introsort over [count] Values ordered by LESS(a, b): a
+// quicksort with median-of-three pivots that finishes short ranges with an
+// insertion sort and falls back to heapsort when it recurses too deeply.
+#define DEFINE_INTROSORT(name, LESS)                                           \
+    static void name##SiftDown(Value *data, size_t root, size_t count) {       \
+        for (;;) {                                                             \
+            size_t child = 2 * root + 1;                                       \
+            if (child >= count) return;                                        \
+            if (child + 1 < count && LESS(data[child], data[child + 1])) child++; \
+            if (!LESS(data[root], data[child])) return;                        \
+            Value swap = data[root];                                           \
+            data[root] = data[child];                                          \
+            data[child] = swap;                                                \
+            root = child;                                                      \
+        }                                                                      \
+    }                                                                          \
+                                                                               \
+    static void name(Value *data, size_t count, int depth) {                   \
+        while (count > 16) {                                                   \
+            if (depth-- == 0) {                                                \
+                for (size_t i = count / 2; i-- > 0;) name##SiftDown(data, i, count); \
+                for (size_t end = count - 1; end > 0; end--) {                 \
+                    Value swap = data[0];                                      \
+                    data[0] = data[end];                                       \
+                    data[end] = swap;                                          \
+                    name##SiftDown(data, 0, end);                              \
+                }                                                              \
+                return;                                                        \
+            }                                                                  \
+                                                                               \
+            size_t mid = (count - 1) / 2;                                      \
+            Value swap;                                                        \
+            if (LESS(data[mid], data[0])) {                                    \
+                swap = data[mid]; data[mid] = data[0]; data[0] = swap;         \
+            }                                                                  \
+            if (LESS(data[count - 1], data[mid])) {                            \
+                swap = data[mid]; data[mid] = data[count - 1]; data[count - 1] = swap; \
+                if (LESS(data[mid], data[0])) {                                \
+                    swap = data[mid]; data[mid] = data[0]; data[0] = swap;     \
+                }                                                              \
+            }                                                                  \
+                                                                               \
+            Value pivot = data[mid];                                           \
+            size_t i = 0;                                                      \
+            size_t j = count - 1;                                              \
+            for (;;) {                                                         \
+                while (LESS(data[i], pivot)) i++;                              \
+                while (LESS(pivot, data[j])) j--;                              \
+                if (i >= j) break;                                             \
+                swap = data[i]; data[i] = data[j]; data[j] = swap;             \
+                i++;                                                           \
+                j--;                                                           \
+            }                                                                  \
+                                                                               \
+            /* Recurse into the smaller half and loop on the larger one. */    \
+            size_t split = j + 1;                                              \
+            if (split < count - split) {                                       \
+                name(data, split, depth);                                      \
+                data += split;                                                 \
+                count -= split;                                                \
+            } else {                                                           \
+                name(data + split, count - split, depth);                      \
+                count = split;                                                 \
+            }                                                                  \
+        }                                                                      \
+                                                                               \
+        for (size_t i = 1; i < count; i++) {                                   \
+            Value value = data[i];                                             \
+            size_t j = i;                                                      \
+            for (; j > 0 && LESS(value, data[j - 1]); j--) data[j] = data[j - 1]; \
+            data[j] = value;                                                   \
+        }                                                                      \
+    }
+
+#define NUM_LESS(a, b) (AS_NUM(a) < AS_NUM(b))
+
+static inline bool stringLess(Value a, Value b) {
+    String *left = AS_STRING(a);
+    String *right = AS_STRING(b);
+    uint32_t length = left->length < right->length ? left->length : right->length;
+    int result = memcmp(left->value, right->value, length);
+    return result < 0 || (result == 0 && left->length < right->length);
+}
+
+// Defines [name] as a stable merge of the sorted runs [low, mid) and
+// [mid, high) of [source] into the same range of [target].
+#define DEFINE_MERGE(name, LESS)                                               \
+    static void name(const Value *source, Value *target, size_t low, size_t mid, size_t high) { \
+        size_t i = low;                                                        \
+        size_t j = mid;                                                        \
+        for (size_t k = low; k < high; k++) {                                  \
+            if (j < high && (i >= mid || LESS(source[j], source[i]))) {        \
+                target[k] = source[j++];                                       \
+            } else {                                                           \
+                target[k] = source[i++];                                       \
+            }                                                                  \
+        }                                                                      \
+    }
+
+DEFINE_INTROSORT(sortNumbers, NUM_LESS)
+DEFINE_INTROSORT(sortStrings, stringLess)
+DEFINE_MERGE(mergeNumbers, NUM_LESS)
+DEFINE_MERGE(mergeStrings, stringLess)
+
+#undef NUM_LESS
+#undef DEFINE_INTROSORT
+#undef DEFINE_MERGE
+
+// Returns the number of elements from which a list is split between the
+// worker threads.
+static uint32_t parallelThreshold(MVM *vm) {
+    return vm->config.parallelThreshold == 0 ? 65536 : vm->config.parallelThreshold;
+}
+
+// Allows about 2*log2(count) levels of partitioning before heapsort.
+static int introsortDepth(size_t count) {
+    int depth = 0;
+    for (size_t n = count; n > 1; n >>= 1) depth += 2;
+    return depth;
+}
+
+// A list of numbers or strings sorted by the worker threads: each thread
+// introsorts one run, then pairs of runs are merged between [data] and
+// [scratch] until a single one is left.
+typedef struct {
+    Value *data;
+    Value *scratch;
+    size_t count;
+    size_t width;
+    bool strings;
+} ParallelSort;
+
+static void sortRunTask(void *data, int index) {
+    ParallelSort *sort = (ParallelSort *) data;
+    size_t low = (size_t) index * sort->width;
+    size_t high = low + sort->width < sort->count ? low + sort->width : sort->count;
+    if (low >= high) return;
+
+    if (sort->strings) {
+        sortStrings(sort->data + low, high - low, introsortDepth(high - low));
+    } else {
+        sortNumbers(sort->data + low, high - low, introsortDepth(high - low));
+    }
+}
+
+static void mergeRunsTask(void *data, int index) {
+    ParallelSort *sort = (ParallelSort *) data;
+    size_t low = (size_t) index * 2 * sort->width;
+    size_t mid = low + sort->width < sort->count ? low + sort->width : sort->count;
+    size_t high = mid + sort->width < sort->count ? mid + sort->width : sort->count;
+
+    if (sort->strings) {
+        mergeStrings(sort->data, sort->scratch, low, mid, high);
+    } else {
+        mergeNumbers(sort->data, sort->scratch, low, mid, high);
+    }
+}
+
+static void sortParallel(MVM *vm, Workers *workers, List *list, bool strings) {
+    size_t count = (size_t) list->elements.count;
+    int runs = MSCWorkersThreadCount(workers);
+    Value *scratch = ALLOCATE_ARRAY(vm, Value, count);
+
+    ParallelSort sort;
+    sort.data = list->elements.data;
+    sort.scratch = scratch;
+    sort.count = count;
+    sort.width = (count + runs - 1) / runs;
+    sort.strings = strings;
+    MSCWorkersRun(workers, sortRunTask, &sort, runs);
+
+    while (sort.width < count) {
+        size_t pairs = (count + 2 * sort.width - 1) / (2 * sort.width);
+        MSCWorkersRun(workers, mergeRunsTask, &sort, (int) pairs);
+        Value *swap = sort.data;
+        sort.data = sort.scratch;
+        sort.scratch = swap;
+        sort.width *= 2;
+    }
+
+    if (sort.data != list->elements.data) {
+        memcpy(list->elements.data, sort.data, sizeof(Value) * count);
+    }
+    DEALLOCATE(vm, scratch);
+}
+
+// Sorts the list in place with the default `<` ordering when every element is
+// a number or every element is a string, without calling back into the
+// script. Returns false, leaving the list untouched, for any other list so that
+// the caller can fall back to calling `<`.
+DEF_PRIMITIVE(list_sortDefault) {
+    List *list = AS_LIST(args[0]);
+    Value *data = list->elements.data;
+    size_t count = (size_t) list->elements.count;
+    if (count < 2) RETURN_TRUE;
+
+    bool numbers = true;
+    bool strings = true;
+    for (size_t i = 0; i < count && (numbers || strings); i++) {
+        if (!IS_NUM(data[i])) numbers = false;
+        if (!IS_STRING(data[i])) strings = false;
+    }
+
+    if (!numbers && !strings) RETURN_FALSE;
+
+    Workers *workers = count >= parallelThreshold(vm) ? MSCGetWorkers(vm) : NULL;
+    if (workers != NULL && MSCWorkersThreadCount(workers) > 1) {
+        sortParallel(vm, workers, list, strings);
+    } else if (numbers) {
+        sortNumbers(data, count, introsortDepth(count));
+    } else {
+        sortStrings(data, count, introsortDepth(count));
+    }
+    RETURN_TRUE;
+}
+
+enum { REDUCE_SUM, REDUCE_MIN, REDUCE_MAX };
+
+// Sums are added up in blocks of this many numbers, and the block sums then
+// in order, so that the result doesn't depend on the number of threads.
+#define REDUCE_BLOCK 4096
+
+// A reduction of a list split into [pieces] contiguous ranges of blocks.
+// Each piece leaves in [partials] the sum of each of its blocks, or its
+// smallest or largest element, or null if it found an element of another type
+// than the first one.
+typedef struct {
+    const Value *data;
+    size_t count;
+    int kind;
+    int pieces;
+    Value *partials;
+} ListReduce;
+
+static void reduceTask(void *data, int index) {
+    ListReduce *reduce = (ListReduce *) data;
+    size_t blocks = (reduce->count + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+    size_t perPiece = (blocks + reduce->pieces - 1) / reduce->pieces;
+    size_t firstBlock = (size_t) index * perPiece;
+    size_t lastBlock = firstBlock + perPiece < blocks ? firstBlock + perPiece : blocks;
+    const Value *values = reduce->data;
+
+    if (reduce->kind == REDUCE_SUM) {
+        for (size_t block = firstBlock; block < lastBlock; block++) {
+            size_t end = (block + 1) * REDUCE_BLOCK < reduce->count ? (block + 1) * REDUCE_BLOCK : reduce->count;
+            double sum = 0;
+            Value result = NULL_VAL;
+            size_t i = block * REDUCE_BLOCK;
+            for (; i < end && IS_NUM(values[i]); i++) sum += AS_NUM(values[i]);
+            if (i == end) result = NUM_VAL(sum);
+            reduce->partials[block] = result;
+        }
+        return;
+    }
+
+    if (firstBlock >= lastBlock) {
+        reduce->partials[index] = UNDEFINED_VAL;
+        return;
+    }
+    size_t end = lastBlock * REDUCE_BLOCK < reduce->count ? lastBlock * REDUCE_BLOCK : reduce->count;
+    bool wantLess = reduce->kind == REDUCE_MIN;
+    Value best = values[firstBlock * REDUCE_BLOCK];
+    if (IS_NUM(values[0])) {
+        double bestNum = AS_NUM(best);
+        for (size_t i = firstBlock * REDUCE_BLOCK; i < end; i++) {
+            if (!IS_NUM(values[i])) {
+                reduce->partials[index] = NULL_VAL;
+                return;
+            }
+            double value = AS_NUM(values[i]);
+            if (wantLess ? value < bestNum : value > bestNum) bestNum = value;
+        }
+        best = NUM_VAL(bestNum);
+    } else {
+        for (size_t i = firstBlock * REDUCE_BLOCK; i < end; i++) {
+            if (!IS_STRING(values[i])) {
+                reduce->partials[index] = NULL_VAL;
+                return;
+            }
+            if (wantLess ? stringLess(values[i], best) : stringLess(best, values[i])) best = values[i];
+        }
+    }
+    reduce->partials[index] = best;
+}
+
+// Reduces [list] natively when it holds only numbers, or for the smallest and
+// largest element only strings. Large lists are split between the worker
+// threads. Returns null for any other list so that the caller can fall back to
+// the script, and for an empty one.
+static Value reduceList(MVM *vm, List *list, int kind) {
+    size_t count = (size_t) list->elements.count;
+    if (count == 0) return kind == REDUCE_SUM ? NUM_VAL(0) : NULL_VAL;
+    if (!IS_NUM(list->elements.data[0]) && (kind == REDUCE_SUM || !IS_STRING(list->elements.data[0]))) {
+        return NULL_VAL;
+    }
+
+    Workers *workers = count >= parallelThreshold(vm) ? MSCGetWorkers(vm) : NULL;
+    size_t blocks = (count + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+    ListReduce reduce;
+    reduce.count = count;
+    reduce.kind = kind;
+    reduce.pieces = MSCWorkersThreadCount(workers);
+    if ((size_t) reduce.pieces > blocks) reduce.pieces = (int) blocks;
+    size_t partialCount = kind == REDUCE_SUM ? blocks : (size_t) reduce.pieces;
+    reduce.partials = ALLOCATE_ARRAY(vm, Value, partialCount);
+    reduce.data = list->elements.data;
+    MSCWorkersRun(workers, reduceTask, &reduce, reduce.pieces);
+
+    Value result = UNDEFINED_VAL;
+    double sum = 0;
+    for (size_t i = 0; i < partialCount; i++) {
+        Value partial = reduce.partials[i];
+        if (IS_NULL(partial)) {
+            result = NULL_VAL;
+            break;
+        }
+        // The last pieces are left without a block when the blocks do not
+        // split evenly.
+        if (IS_UNDEFINED(partial)) continue;
+        if (kind == REDUCE_SUM) {
+            sum += AS_NUM(partial);
+        } else if (IS_UNDEFINED(result)) {
+            result = partial;
+        } else if (IS_NUM(partial)) {
+            if (kind == REDUCE_MIN ? AS_NUM(partial) < AS_NUM(result) : AS_NUM(partial) > AS_NUM(result)) {
+                result = partial;
+            }
+        } else if (kind == REDUCE_MIN ? stringLess(partial, result) : stringLess(result, partial)) {
+            result = partial;
+        }
+    }
+    DEALLOCATE(vm, reduce.partials);
+
+    if (kind == REDUCE_SUM && !IS_NULL(result)) return NUM_VAL(sum);
+    return result;
+}
+
+#undef REDUCE_BLOCK
+
+DEF_PRIMITIVE(list_sum) {
+    RETURN_VAL(reduceList(vm, AS_LIST(args[0]), REDUCE_SUM));
+}
+
+DEF_PRIMITIVE(list_min) {
+    RETURN_VAL(reduceList(vm, AS_LIST(args[0]), REDUCE_MIN));
+}
+
+DEF_PRIMITIVE(list_max) {
+    RETURN_VAL(reduceList(vm, AS_LIST(args[0]), REDUCE_MAX));
+}
+
+// Returns a new list with the first occurrence of each element, when every
+// element can be a Wala key. Returns null otherwise.
+DEF_PRIMITIVE(list_distinct) {
+    List *list = AS_LIST(args[0]);
+    for (int i = 0; i < list->elements.count; i++) {
+        if (!MSCMapIsValidKey(list->elements.data[i])) RETURN_NULL;
+    }
+
+    List *result = MSCListFrom(vm, 0);
+    MSCPushRoot(vm->gc, (Object *) result);
+    Set *seen = MSCSetFrom(vm);
+    MSCPushRoot(vm->gc, (Object *) seen);
+    for (int i = 0; i < list->elements.count; i++) {
+        Value element = list->elements.data[i];
+        if (MSCSetAdd(seen, vm, element)) MSCWriteValueBuffer(vm, &result->elements, element);
+    }
+    MSCPopRoot(vm->gc);
+    MSCPopRoot(vm->gc);
+    RETURN_OBJ(result);
+}
+
+// Looks for a number, bool, gansan or string, whose `==` is built in. Returns
+// gansan for any other value, which may override `==`, so that the caller can
+// fall back to comparing it in script.
+DEF_PRIMITIVE(list_contains) {
+    Value value = args[1];
+    if (!IS_NUM(value) && !IS_BOOL(value) && !IS_NULL(value) && !IS_STRING(value)) RETURN_NULL;
+    RETURN_BOOL(MSCListIndexOf(AS_LIST(args[0]), vm, value) != -1);
+}
+
+DEF_PRIMITIVE(list_toList) {
+    List *list = AS_LIST(args[0]);
+    List *result = MSCListFrom(vm, list->elements.count);
+    memcpy(result->elements.data, list->elements.data, sizeof(Value) * list->elements.count);
+    RETURN_OBJ(result);
+}
+
+// Concatenates two lists. Other sequences are appended by the script.
+DEF_PRIMITIVE(list_concat) {
+    List *list = AS_LIST(args[0]);
+    List *other = AS_LIST(args[1]);
+    List *result = MSCListFrom(vm, list->elements.count + other->elements.count);
+    memcpy(result->elements.data, list->elements.data, sizeof(Value) * list->elements.count);
+    memcpy(result->elements.data + list->elements.count, other->elements.data,
+           sizeof(Value) * other->elements.count);
+    RETURN_OBJ(result);
+}
+
+DEF_PRIMITIVE(list_repeat) {
+    if (!IS_NUM(args[1]) || trunc(AS_NUM(args[1])) != AS_NUM(args[1]) || AS_NUM(args[1]) < 0) {
+        RETURN_ERROR("Count must be a non-negative integer.");
+    }
+    List *list = AS_LIST(args[0]);
+    int length = list->elements.count;
+    if (length == 0) RETURN_OBJ(MSCListFrom(vm, 0));
+
+    // The element count of a list is an int.
+    if (AS_NUM(args[1]) > (double) (INT32_MAX / length)) RETURN_ERROR("Count is too large.");
+
+    int count = (int) AS_NUM(args[1]);
+    List *result = MSCListFrom(vm, length * count);
+    for (int i = 0; i < count; i++) {
+        memcpy(result->elements.data + i * length, list->elements.data, sizeof(Value) * length);
+    }
+    RETURN_OBJ(result);
+}
+
+// Joins a list of strings and numbers. Returns gansan for any other list, or a
+// separator that is not a string, so that the caller can fall back to calling
+// `sebenma` on each element.
+DEF_PRIMITIVE(list_join) {
+    if (!IS_STRING(args[1])) RETURN_NULL;
+    RETURN_VAL(MSCListJoin(AS_LIST(args[0]), vm, AS_STRING(args[1])));
+}
+
+enum { PIPELINE_MAP, PIPELINE_FILTER, PIPELINE_SKIP, PIPELINE_TAKE };
+
+enum { PIPELINE_NEXT, PIPELINE_CURRENT, PIPELINE_FINISHED };
+
+List *MSCPipelineStart(MVM *vm, Value pipeline, Value step) {
+    Value *fields = AS_INSTANCE(pipeline)->fields;
+    ValueBuffer *args = &AS_LIST(fields[PIPELINE_FIELD_ARGS])->elements;
+
+    List *state = MSCListFrom(vm, PIPELINE_COUNTERS + args->count);
+    Value *slots = state->elements.data;
+    slots[PIPELINE_ITERATOR] = NULL_VAL;
+    slots[PIPELINE_VALUE] = NULL_VAL;
+    slots[PIPELINE_STEP] = step;
+    slots[PIPELINE_SEQUENCE] = fields[PIPELINE_FIELD_SEQUENCE];
+    slots[PIPELINE_KINDS] = fields[PIPELINE_FIELD_KINDS];
+    slots[PIPELINE_WAITING] = NUM_VAL(PIPELINE_READY);
+    slots[PIPELINE_POSITION] = NUM_VAL(0);
+    slots[PIPELINE_APPLIED] = NUM_VAL(0);
+    slots[PIPELINE_STATUS] = NUM_VAL(PIPELINE_NEXT);
+    memcpy(slots + PIPELINE_COUNTERS, args->data, sizeof(Value) * args->count);
+    return state;
+}
+
+// Returns the first yelema stage in [from, to), or -1.
+static int pipelinePendingMap(Value *kinds, int from, int to) {
+    for (int i = from; i < to; i++) {
+        if (AS_NUM(kinds[i]) == PIPELINE_MAP) return i;
+    }
+    return -1;
+}
+
+int MSCPipelineStep(Value *state, Value answer) {
+    List *kindList = AS_LIST(state[PIPELINE_KINDS]);
+    Value *kinds = kindList->elements.data;
+    int count = kindList->elements.count;
+    Value *counters = state + PIPELINE_COUNTERS;
+    int waiting = (int) AS_NUM(state[PIPELINE_WAITING]);
+    int position = (int) AS_NUM(state[PIPELINE_POSITION]);
+    int applied = (int) AS_NUM(state[PIPELINE_APPLIED]);
+    int status = (int) AS_NUM(state[PIPELINE_STATUS]);
+    int result = PIPELINE_READY;
+
+    if (waiting == PIPELINE_ITERATE) {
+        state[PIPELINE_ITERATOR] = answer;
+        if (isFalsyValue(answer)) status = PIPELINE_FINISHED;
+        else result = PIPELINE_ITERATOR_VALUE;
+    } else if (waiting == PIPELINE_ITERATOR_VALUE) {
+        state[PIPELINE_VALUE] = answer;
+        status = PIPELINE_CURRENT;
+        position = applied = 0;
+    } else if (waiting >= 0) {
+        if (AS_NUM(kinds[waiting]) == PIPELINE_MAP) {
+            state[PIPELINE_VALUE] = answer;
+            applied = waiting + 1;
+        } else if (isFalsyValue(answer)) {
+            status = PIPELINE_NEXT;
+        } else {
+            applied = position = waiting + 1;
+        }
+    }
+
+    while (result == PIPELINE_READY && status != PIPELINE_FINISHED) {
+        if (status == PIPELINE_NEXT) {
+            // A taa stage that took everything ends the chain before the
+            // sequence is stepped again.
+            for (int i = 0; i < count; i++) {
+                if (AS_NUM(kinds[i]) == PIPELINE_TAKE && AS_NUM(counters[i]) <= 0) {
+                    status = PIPELINE_FINISHED;
+                }
+            }
+            if (status == PIPELINE_FINISHED) break;
+
+            // Lists are stepped here with the same rules as list_iterate.
+            // Other sequences are asked for their iterate(_,_).
+            Value sequence = state[PIPELINE_SEQUENCE];
+            Value step = state[PIPELINE_STEP];
+            Value iterator = state[PIPELINE_ITERATOR];
+            if (!IS_LIST(sequence) || !IS_NUM(step) || trunc(AS_NUM(step)) != AS_NUM(step) ||
+                !(IS_NULL(iterator) || IS_NUM(iterator))) {
+                result = PIPELINE_ITERATE;
+                break;
+            }
+            ValueBuffer *elements = &AS_LIST(sequence)->elements;
+            double index;
+            if (IS_NULL(iterator)) {
+                index = AS_NUM(step) > 0 ? 0 : elements->count - 1;
+            } else {
+                index = AS_NUM(iterator) + AS_NUM(step);
+            }
+            if (index < 0 || index >= elements->count || trunc(index) != index) {
+                status = PIPELINE_FINISHED;
+                break;
+            }
+            state[PIPELINE_ITERATOR] = NUM_VAL(index);
+            state[PIPELINE_VALUE] = elements->data[(uint32_t) index];
+            status = PIPELINE_CURRENT;
+            position = applied = 0;
+        }
+
+        // Run the stages up to the next yoroMin. yelema stages are left
+        // pending until a yoroMin or the end needs the value, so pan and taa
+        // never evaluate them.
+        while (position < count) {
+            int kind = (int) AS_NUM(kinds[position]);
+            if (kind == PIPELINE_FILTER) break;
+            if (kind == PIPELINE_SKIP && AS_NUM(counters[position]) > 0) {
+                counters[position] = NUM_VAL(AS_NUM(counters[position]) - 1);
+                status = PIPELINE_NEXT;
+                break;
+            }
+            if (kind == PIPELINE_TAKE) counters[position] = NUM_VAL(AS_NUM(counters[position]) - 1);
+            position++;
+        }
+        if (status == PIPELINE_NEXT) continue;
+
+        result = pipelinePendingMap(kinds, applied, position);
+        if (result == -1 && position < count) result = position;
+
+        // Otherwise the value went through every stage.
+        if (result == -1) {
+            result = PIPELINE_READY;
+            status = PIPELINE_NEXT;
+            break;
+        }
+    }
+
+    if (status == PIPELINE_FINISHED) result = PIPELINE_DONE;
+    state[PIPELINE_WAITING] = NUM_VAL(result);
+    state[PIPELINE_POSITION] = NUM_VAL(position);
+    state[PIPELINE_APPLIED] = NUM_VAL(applied);
+    state[PIPELINE_STATUS] = NUM_VAL(status);
+    return result;
+}
+
+DEF_PRIMITIVE(pipeline_start) {
+    RETURN_OBJ(MSCPipelineStart(vm, args[0], args[1]));
+}
+
+DEF_PRIMITIVE(pipeline_step) {
+    int result = MSCPipelineStep(AS_LIST(args[1])->elements.data, args[2]);
+    if (result == PIPELINE_DONE) RETURN_FALSE;
+    RETURN_NUM(result);
+}
+
+DEF_PRIMITIVE(list_subscript) {
+    List *list = AS_LIST(args[0]);
+
+    if (IS_NUM(args[1])) {
+        uint32_t index = validateIndex(vm, args[1], (uint32_t) list->elements.count,
+                                       "Subscript");
+        if (index == UINT32_MAX) return false;
+
+        RETURN_VAL(list->elements.data[index]);
+    }
+    if (!IS_RANGE(args[1])) {
+        RETURN_ERROR("Subscript must be a number or a range.");
+    }
+
+    int step;
+    uint32_t count = (uint32_t) list->elements.count;
+    uint32_t start = calculateRange(vm, AS_RANGE(args[1]), &count, &step);
+    if (start == UINT32_MAX) return false;
+
+    List *result = MSCListFrom(vm, count);
+    for (uint32_t i = 0; i < count; i++) {
+        result->elements.data[i] = list->elements.data[start + i * step];
+    }
+    RETURN_OBJ(result);
+
+}
+
+DEF_PRIMITIVE(list_subscriptSetter) {
+    List *list = AS_LIST(args[0]);
+    uint32_t index = validateIndex(vm, args[1], (uint32_t) (list->elements.count),
+                                   "Subscript");
+    if (index == UINT32_MAX) return false;
+
+    list->elements.data[index] = args[2];
+    RETURN_VAL(args[2]);
+}
+
+DEF_PRIMITIVE(map_new) {
+    RETURN_OBJ(MSCMapFrom(vm));
+}
+
+DEF_PRIMITIVE(map_subscript) {
+    if (!validateKey(vm, args[1])) return false;
+
+    Map *map = AS_MAP(args[0]);
+    Value value = MSCMapGet(map, args[1]);
+    if (IS_UNDEFINED(value)) RETURN_NULL;
+
+    RETURN_VAL(value);
+}
+
+DEF_PRIMITIVE(map_subscriptSetter) {
+    if (!validateKey(vm, args[1])) return false;
+
+    MSCMapSet(AS_MAP(args[0]), vm, args[1], args[2]);
+    RETURN_VAL(args[2]);
+}
+
+// Adds an entry to the map and then returns the map itself. This is called by
+// the compiler when compiling map literals instead of using [_]=(_) to
+// minimize stack churn.
+DEF_PRIMITIVE(map_addCore) {
+    if (!validateKey(vm, args[1])) return false;
+
+    MSCMapSet(AS_MAP(args[0]), vm, args[1], args[2]);
+
+    // Return the map itself.
+    RETURN_VAL(args[0]);
+}
+
+DEF_PRIMITIVE(map_addAllCore) {
+    Map *map = AS_MAP(args[0]);
+    if (!IS_MAP(args[1])) {
+        RETURN_ERROR("Only map can be spread in an other map");
+    }
+    Map *other = AS_MAP(args[1]);
+
+    MSCMapAddAll(map, vm, other);
+    // Return the map itself.
+    RETURN_VAL(args[0]);
+}
+
+DEF_PRIMITIVE(map_clear) {
+    MSCMapClear(AS_MAP(args[0]), vm);
+    RETURN_NULL;
+}
+
+DEF_PRIMITIVE(map_containsKey) {
+    if (!validateKey(vm, args[1])) return false;
+
+    RETURN_BOOL(!IS_UNDEFINED(MSCMapGet(AS_MAP(args[0]), args[1])));
+}
+
+DEF_PRIMITIVE(map_count) {
+    RETURN_NUM(AS_MAP(args[0])->count);
+}
+
+DEF_PRIMITIVE(map_iterate) {
+    Map *map = AS_MAP(args[0]);
+    if (!validateInt(vm, args[2], "Step")) return false;
+    int32_t step = (int32_t) AS_NUM(args[2]);
+
+    if (map->count == 0) RETURN_FALSE;
+
+    // If we're starting the iteration, start at the first or the last used entry.
+    // Entries are stored in insertion order, so that is the iteration order too.
+    int index = step < 0 ? (int) map->used - 1 : 0;
+
+    // Otherwise, start one past the last entry we stopped at or the first entry.
+    if (!IS_NULL(args[1])) {
+        if (!validateInt(vm, args[1], "Iterator")) return false;
+
+        // if (AS_NUM(args[1]) <= 0) RETURN_FALSE;
+        index = (int) AS_NUM(args[1]);
+        if (index < 0 || index >= (int) map->used) RETURN_FALSE;
+
+        // Advance the iterator.
+        index += step;
+    }
+
+    // Find a used entry, if any.
+    if (step > 0) {
+        for (; index < (int) map->used; index++) {
+
+            if (!IS_UNDEFINED(map->entries[index].key)) {
+                RETURN_NUM(index);
+            }
+        }
+    } else {
+        for (; index >= 0; index--) {
+            if (!IS_UNDEFINED(map->entries[index].key)) RETURN_NUM(index);
+        }
+    }
+
+    // If we get here, walked all of the entries.
+    RETURN_FALSE;
+}
+
+DEF_PRIMITIVE(map_remove) {
+    if (!validateKey(vm, args[1])) return false;
+
+    RETURN_VAL(MSCMapRemove(AS_MAP(args[0]), vm, args[1]));
+}
+
+DEF_PRIMITIVE(map_keyIteratorValue) {
+    Map *map = AS_MAP(args[0]);
+    uint32_t index = validateIndex(vm, args[1], map->used, "Iterator");
+    if (index == UINT32_MAX) return false;
+
+    MapEntry *entry = &map->entries[index];
+    if (IS_UNDEFINED(entry->key)) {
+        RETURN_ERROR("Invalid map iterator.");
+    }
+
+    RETURN_VAL(entry->key);
+}
+
+DEF_PRIMITIVE(map_valueIteratorValue) {
+    Map *map = AS_MAP(args[0]);
+    uint32_t index = validateIndex(vm, args[1], map->used, "Iterator");
+    if (index == UINT32_MAX) return false;
+
+    MapEntry *entry = &map->entries[index];
+    if (IS_UNDEFINED(entry->key)) {
+        RETURN_ERROR("Invalid map iterator.");
+    }
+    RETURN_VAL(entry->value);
+}
+
+DEF_PRIMITIVE(set_new) {
+    RETURN_OBJ(MSCSetFrom(vm));
+}
+
+DEF_PRIMITIVE(set_add) {
+    if (!validateKey(vm, args[1])) return false;
+
+    MSCSetAdd(AS_SET(args[0]), vm, args[1]);
+    RETURN_VAL(args[1]);
+}
+
+DEF_PRIMITIVE(set_clear) {
+    MSCSetClear(AS_SET(args[0]), vm);
+    RETURN_NULL;
+}
+
+DEF_PRIMITIVE(set_contains) {
+    if (!validateKey(vm, args[1])) return false;
+
+    RETURN_BOOL(MSCSetContains(AS_SET(args[0]), args[1]));
+}
+
+DEF_PRIMITIVE(set_count) {
+    RETURN_NUM(AS_SET(args[0])->count);
+}
+
+DEF_PRIMITIVE(set_remove) {
+    if (!validateKey(vm, args[1])) return false;
+
+    RETURN_BOOL(MSCSetRemove(AS_SET(args[0]), vm, args[1]));
+}
+
+DEF_PRIMITIVE(set_iterate) {
+    Set *set = AS_SET(args[0]);
+    if (!validateInt(vm, args[2], "Step")) return false;
+    int32_t step = (int32_t) AS_NUM(args[2]);
+
+    if (set->count == 0) RETURN_FALSE;
+
+    // Keys are stored in insertion order, so that is the iteration order too.
+    int index = step < 0 ? (int) set->used - 1 : 0;
+
+    if (!IS_NULL(args[1])) {
+        if (!validateInt(vm, args[1], "Iterator")) return false;
+
+        index = (int) AS_NUM(args[1]);
+        if (index < 0 || index >= (int) set->used) RETURN_FALSE;
+
+        // Advance the iterator.
+        index += step;
+    }
+
+    // Skip the holes left by removed keys.
+    if (step > 0) {
+        for (; index < (int) set->used; index++) {
+            if (!IS_UNDEFINED(set->keys[index])) RETURN_NUM(index);
+        }
+    } else {
+        for (; index >= 0; index--) {
+            if (!IS_UNDEFINED(set->keys[index])) RETURN_NUM(index);
+        }
+    }
+
+    RETURN_FALSE;
+}
+
+DEF_PRIMITIVE(set_iteratorValue) {
+    Set *set = AS_SET(args[0]);
+    uint32_t index = validateIndex(vm, args[1], set->used, "Iterator");
+    if (index == UINT32_MAX) return false;
+
+    if (IS_UNDEFINED(set->keys[index])) {
+        RETURN_ERROR("Invalid set iterator.");
+    }
+    RETURN_VAL(set->keys[index]);
+}
+
+// Set algebra. The result keeps the insertion order of the left operand,
+// followed by the new keys of the right one.
+static bool validateSet(MVM *vm, Value arg) {
+    if (IS_SET(arg)) return true;
+    RETURN_ERROR("Right operand must be a Jekulu.");
+}
+
+DEF_PRIMITIVE(set_union) {
+    if (!validateSet(vm, args[1])) return false;
+    Set *left = AS_SET(args[0]);
+    Set *right = AS_SET(args[1]);
+
+    Set *result = MSCSetFrom(vm);
+    MSCPushRoot(vm->gc, (Object *) result);
+    for (uint32_t i = 0; i < left->used; i++) {
+        if (!IS_UNDEFINED(left->keys[i])) MSCSetAdd(result, vm, left->keys[i]);
+    }
+    for (uint32_t i = 0; i < right->used; i++) {
+        if (!IS_UNDEFINED(right->keys[i])) MSCSetAdd(result, vm, right->keys[i]);
+    }
+    MSCPopRoot(vm->gc);
+    RETURN_OBJ(result);
+}
+
+DEF_PRIMITIVE(set_intersection) {
+    if (!validateSet(vm, args[1])) return false;
+    Set *left = AS_SET(args[0]);
+    Set *right = AS_SET(args[1]);
+
+    Set *result = MSCSetFrom(vm);
+    MSCPushRoot(vm->gc, (Object *) result);
+    for (uint32_t i = 0; i < left->used; i++) {
+        Value key = left->keys[i];
+        if (!IS_UNDEFINED(key) && MSCSetContains(right, key)) MSCSetAdd(result, vm, key);
+    }
+    MSCPopRoot(vm->gc);
+    RETURN_OBJ(result);
+}
+
+DEF_PRIMITIVE(set_difference) {
+    if (!validateSet(vm, args[1])) return false;
+    Set *left = AS_SET(args[0]);
+    Set *right = AS_SET(args[1]);
+
+    Set *result = MSCSetFrom(vm);
+    MSCPushRoot(vm->gc, (Object *) result);
+    for (uint32_t i = 0; i < left->used; i++) {
+        Value key = left->keys[i];
+        if (!IS_UNDEFINED(key) && !MSCSetContains(right, key)) MSCSetAdd(result, vm, key);
+    }
+    MSCPopRoot(vm->gc);
+    RETURN_OBJ(result);
+}
+
+DEF_PRIMITIVE(deque_new) {
+    RETURN_OBJ(MSCDequeFrom(vm));
+}
+
+DEF_PRIMITIVE(deque_pushBack) {
+    MSCDequePushBack(AS_DEQUE(args[0]), vm, args[1]);
+    RETURN_VAL(args[1]);
+}
+
+DEF_PRIMITIVE(deque_pushFront) {
+    MSCDequePushFront(AS_DEQUE(args[0]), vm, args[1]);
+    RETURN_VAL(args[1]);
+}
+
+DEF_PRIMITIVE(deque_popBack) {
+    Deque *deque = AS_DEQUE(args[0]);
+    if (deque->count == 0) RETURN_ERROR("Can't remove from an empty Layini.");
+    RETURN_VAL(MSCDequePopBack(deque, vm));
+}
+
+DEF_PRIMITIVE(deque_popFront) {
+    Deque *deque = AS_DEQUE(args[0]);
+    if (deque->count == 0) RETURN_ERROR("Can't remove from an empty Layini.");
+    RETURN_VAL(MSCDequePopFront(deque, vm));
+}
+
+DEF_PRIMITIVE(deque_first) {
+    Deque *deque = AS_DEQUE(args[0]);
+    if (deque->count == 0) RETURN_NULL;
+    RETURN_VAL(*MSCDequeAt(deque, 0));
+}
+
+DEF_PRIMITIVE(deque_last) {
+    Deque *deque = AS_DEQUE(args[0]);
+    if (deque->count == 0) RETURN_NULL;
+    RETURN_VAL(*MSCDequeAt(deque, deque->count - 1));
+}
+
+DEF_PRIMITIVE(deque_clear) {
+    MSCDequeClear(AS_DEQUE(args[0]), vm);
+    RETURN_NULL;
+}
+
+DEF_PRIMITIVE(deque_count) {
+    RETURN_NUM(AS_DEQUE(args[0])->count);
+}
+
+DEF_PRIMITIVE(deque_subscript) {
+    Deque *deque = AS_DEQUE(args[0]);
+    uint32_t index = validateIndex(vm, args[1], deque->count, "Subscript");
+    if (index == UINT32_MAX) return false;
+    RETURN_VAL(*MSCDequeAt(deque, index));
+}
+
+DEF_PRIMITIVE(deque_subscriptSetter) {
+    Deque *deque = AS_DEQUE(args[0]);
+    uint32_t index = validateIndex(vm, args[1], deque->count, "Subscript");
+    if (index == UINT32_MAX) return false;
+    *MSCDequeAt(deque, index) = args[2];
+    RETURN_VAL(args[2]);
+}
+
+// Iterators are indexes from the front, as for lists.
+DEF_PRIMITIVE(deque_iterate) {
+    Deque *deque = AS_DEQUE(args[0]);
+    if (!validateInt(vm, args[2], "Step")) return false;
+    int32_t step = (int32_t) AS_NUM(args[2]);
+
+    if (IS_NULL(args[1])) {
+        if (deque->count == 0) RETURN_FALSE;
+        RETURN_NUM(step > 0 ? 0 : deque->count - 1);
+    }
+
+    if (!validateInt(vm, args[1], "Iterator")) return false;
+
+    double index = AS_NUM(args[1]) + step;
+    if (index < 0 || index >= deque->count) RETURN_FALSE;
+    RETURN_NUM(index);
+}
+
+DEF_PRIMITIVE(deque_iteratorValue) {
+    Deque *deque = AS_DEQUE(args[0]);
+    uint32_t index = validateIndex(vm, args[1], deque->count, "Iterator");
+    if (index == UINT32_MAX) return false;
+    RETURN_VAL(*MSCDequeAt(deque, index));
+}
+
+// Heaps whose priorities are all numbers, or all strings, and that have no
+// comparer are sifted here. Any other heap is left for Sinsin to sift in the
+// script with sanfe_ and duguma_.
+static inline bool heapBefore(const Heap *heap, uint32_t a, uint32_t b) {
+    Value left = heap->entries.data[2 * a];
+    Value right = heap->entries.data[2 * b];
+    if (heap->order == HEAP_ORDER_NUMBERS) return AS_NUM(left) < AS_NUM(right);
+    return stringLess(left, right);
+}
+
+static inline void heapSwap(Heap *heap, uint32_t a, uint32_t b) {
+    Value *entries = heap->entries.data;
+    Value priority = entries[2 * a];
+    Value value = entries[2 * a + 1];
+    entries[2 * a] = entries[2 * b];
+    entries[2 * a + 1] = entries[2 * b + 1];
+    entries[2 * b] = priority;
+    entries[2 * b + 1] = value;
+}
+
+static void heapSiftUp(Heap *heap, uint32_t index) {
+    while (index > 0) {
+        uint32_t parent = (index - 1) / 2;
+        if (!heapBefore(heap, index, parent)) return;
+        heapSwap(heap, index, parent);
+        index = parent;
+    }
+}
+
+static void heapSiftDown(Heap *heap, uint32_t index) {
+    uint32_t count = (uint32_t) heap->entries.count / 2;
+    for (;;) {
+        uint32_t best = index;
+        uint32_t left = 2 * index + 1;
+        if (left < count && heapBefore(heap, left, best)) best = left;
+        if (left + 1 < count && heapBefore(heap, left + 1, best)) best = left + 1;
+        if (best == index) return;
+        heapSwap(heap, index, best);
+        index = best;
+    }
+}
+
+DEF_PRIMITIVE(heap_new) {
+    RETURN_OBJ(MSCHeapFrom(vm, NULL_VAL));
+}
+
+DEF_PRIMITIVE(heap_newWithComparer) {
+    if (!IS_CLOSURE(args[1])) RETURN_ERROR("Comparer must be a function.");
+    RETURN_OBJ(MSCHeapFrom(vm, args[1]));
+}
+
+// Adds [value] with [priority] at the end of the heap, and sifts it up when
+// the heap is ordered natively. Returns false when the script must do it.
+DEF_PRIMITIVE(heap_push) {
+    Heap *heap = AS_HEAP(args[0]);
+    Value priority = args[2];
+
+    if (heap->order == HEAP_ORDER_ANY) {
+        heap->order = IS_NUM(priority) ? HEAP_ORDER_NUMBERS
+                                       : IS_STRING(priority) ? HEAP_ORDER_STRINGS : HEAP_ORDER_SCRIPT;
+    } else if ((heap->order == HEAP_ORDER_NUMBERS && !IS_NUM(priority)) ||
+               (heap->order == HEAP_ORDER_STRINGS && !IS_STRING(priority))) {
+        // The entries so far are still in `<` order, which the script keeps up.
+        heap->order = HEAP_ORDER_SCRIPT;
+    }
+
+    MSCWriteValueBuffer(vm, &heap->entries, priority);
+    MSCWriteValueBuffer(vm, &heap->entries, args[1]);
+    if (heap->order == HEAP_ORDER_SCRIPT) RETURN_FALSE;
+
+    heapSiftUp(heap, (uint32_t) heap->entries.count / 2 - 1);
+    RETURN_TRUE;
+}
+
+// Removes the first entry and returns its value. The last entry takes its
+// place, and is sifted down here when the heap is ordered natively.
+DEF_PRIMITIVE(heap_pop) {
+    Heap *heap = AS_HEAP(args[0]);
+    if (heap->entries.count == 0) RETURN_ERROR("Can't remove from an empty Sinsin.");
+
+    Value *entries = heap->entries.data;
+    Value value = entries[1];
+    heap->entries.count -= 2;
+    entries[0] = entries[heap->entries.count];
+    entries[1] = entries[heap->entries.count + 1];
+    if (heap->order != HEAP_ORDER_SCRIPT) heapSiftDown(heap, 0);
+    RETURN_VAL(value);
+}
+
+DEF_PRIMITIVE(heap_isNative) {
+    RETURN_BOOL(AS_HEAP(args[0])->order != HEAP_ORDER_SCRIPT);
+}
+
+DEF_PRIMITIVE(heap_first) {
+    Heap *heap = AS_HEAP(args[0]);
+    if (heap->entries.count == 0) RETURN_NULL;
+    RETURN_VAL(heap->entries.data[1]);
+}
+
+DEF_PRIMITIVE(heap_count) {
+    RETURN_NUM(AS_HEAP(args[0])->entries.count / 2);
+}
+
+DEF_PRIMITIVE(heap_clear) {
+    Heap *heap = AS_HEAP(args[0]);
+    MSCFreeValueBuffer(vm, &heap->entries);
+    heap->order = IS_NULL(heap->comparer) ? HEAP_ORDER_ANY : HEAP_ORDER_SCRIPT;
+    RETURN_NULL;
+}
+
+DEF_PRIMITIVE(heap_comparer) {
+    RETURN_VAL(AS_HEAP(args[0])->comparer);
+}
+
+DEF_PRIMITIVE(heap_priority) {
+    Heap *heap = AS_HEAP(args[0]);
+    uint32_t index = validateIndex(vm, args[1], (uint32_t) heap->entries.count / 2, "Index");
+    if (index == UINT32_MAX) return false;
+    RETURN_VAL(heap->entries.data[2 * index]);
+}
+
+DEF_PRIMITIVE(heap_swap) {
+    Heap *heap = AS_HEAP(args[0]);
+    uint32_t count = (uint32_t) heap->entries.count / 2;
+    uint32_t a = validateIndex(vm, args[1], count, "Index 0");
+    if (a == UINT32_MAX) return false;
+    uint32_t b = validateIndex(vm, args[2], count, "Index 1");
+    if (b == UINT32_MAX) return false;
+
+    heapSwap(heap, a, b);
+    RETURN_NULL;
+}
+
+// Iterates over the values in heap order, which is not their priority order.
+DEF_PRIMITIVE(heap_iterate) {
+    Heap *heap = AS_HEAP(args[0]);
+    if (!validateInt(vm, args[2], "Step")) return false;
+    int32_t step = (int32_t) AS_NUM(args[2]);
+    double count = heap->entries.count / 2;
+
+    if (IS_NULL(args[1])) {
+        if (count == 0) RETURN_FALSE;
+        RETURN_NUM(step > 0 ? 0 : count - 1);
+    }
+
+    if (!validateInt(vm, args[1], "Iterator")) return false;
+
+    double index = AS_NUM(args[1]) + step;
+    if (index < 0 || index >= count) RETURN_FALSE;
+    RETURN_NUM(index);
+}
+
+DEF_PRIMITIVE(heap_iteratorValue) {
+    Heap *heap = AS_HEAP(args[0]);
+    uint32_t index = validateIndex(vm, args[1], (uint32_t) heap->entries.count / 2, "Iterator");
+    if (index == UINT32_MAX) return false;
+    RETURN_VAL(heap->entries.data[2 * index + 1]);
+}
+
+DEF_PRIMITIVE(channel_new) {
+    RETURN_OBJ(MSCChannelFrom(vm, 0));
+}
+
+DEF_PRIMITIVE(channel_newWithCapacity) {
+    if (!validateInt(vm, args[1], "Capacity")) return false;
+    double capacity = AS_NUM(args[1]);
+    if (capacity < 0) RETURN_ERROR("Capacity cannot be negative.");
+    if (capacity > UINT32_MAX / sizeof(Value)) RETURN_ERROR("Capacity is too large.");
+    RETURN_OBJ(MSCChannelFrom(vm, (uint32_t) capacity));
+}
+
+// Parks the current djuru on [queue], sending [value] if it is the senders
+// of a channel, and suspends it.
+static bool parkOnChannel(MVM *vm, ChannelQueue *queue, Value value) {
+    ChannelWaiter *waiter = ALLOCATE(vm, ChannelWaiter);
+    waiter->djuru = vm->djuru;
+    waiter->value = value;
+    waiter->index = -1;
+    waiter->nextInSelect = waiter;
+    MSCChannelEnqueue(queue, waiter);
+
+    vm->djuru = NULL;
+    vm->apiStack = NULL;
+    return false;
+}
+
+// Makes the djuru parked by [waiter] ready, and frees the waiter along with the
+// other ones of its select. Its call returns [value], or aborts with it if
+// [isError] is true. A select returns the position of the channel and
+// [value] instead.
+static void wakeWaiter(MVM *vm, ChannelWaiter *waiter, Value value, bool isError) {
+    Djuru *djuru = waiter->djuru;
+
+    // Allocate the result of a select while the waiter still keeps the djuru.
+    Value result = value;
+    if (waiter->index >= 0 && !isError) {
+        if (IS_OBJ(value)) MSCPushRoot(vm->gc, AS_OBJ(value));
+        List *pair = MSCListFrom(vm, 2);
+        pair->elements.data[0] = NUM_VAL(waiter->index);
+        pair->elements.data[1] = value;
+        result = OBJ_VAL(pair);
+        if (IS_OBJ(value)) MSCPopRoot(vm->gc);
+    }
+
+    ChannelWaiter *current = waiter;
+    do {
+        ChannelWaiter *next = current->nextInSelect;
+        MSCChannelUnlink(current);
+        DEALLOCATE(vm, current);
+        current = next;
+    } while (current != waiter);
+
+    if (isError) {
+        MSCScheduleError(vm, djuru, result);
+    } else {
+        MSCScheduleReady(vm, djuru, result);
+    }
+}
+
+DEF_PRIMITIVE(channel_send) {
+    Channel *channel = AS_CHANNEL(args[0]);
+    if (channel->closed) RETURN_ERROR("Can't send to a closed Kanali.");
+
+    // Hand the value straight to a parked receiver, or buffer it.
+    if (channel->receivers.head != NULL) {
+        wakeWaiter(vm, channel->receivers.head, args[1], false);
+        RETURN_VAL(args[1]);
+    }
+    if (channel->count < channel->capacity) {
+        channel->buffer[(channel->head + channel->count) % channel->capacity] = args[1];
+        channel->count++;
+        RETURN_VAL(args[1]);
+    }
+
+    // The call only needs one slot for its result, the value once a receiver
+    // takes it.
+    Djuru *current = vm->djuru;
+    current->stackTop--;
+    current->stackTop[-1] = args[1];
+    return parkOnChannel(vm, &channel->senders, args[1]);
+}
+
+// Takes the next value of [channel] into [value] without waiting. That is
+// null once it is closed and empty. Returns false if there is none yet.
+static bool receiveNow(MVM *vm, Channel *channel, Value *value) {
+    ChannelWaiter *sender = channel->senders.head;
+    if (channel->count > 0) {
+        *value = channel->buffer[channel->head];
+        channel->head = (channel->head + 1) % channel->capacity;
+        channel->count--;
+
+        // Let the first parked sender into the slot given back.
+        if (sender != NULL) {
+            channel->buffer[(channel->head + channel->count) % channel->capacity] = sender->value;
+            channel->count++;
+        }
+    } else if (sender != NULL) {
+        *value = sender->value;
+    } else {
+        *value = NULL_VAL;
+        return channel->closed;
+    }
 
-DEF_PRIMITIVE(list_clear) {
-    MSCFreeValueBuffer(vm, &AS_LIST(args[0])->elements);
-    RETURN_NULL;
+    if (sender != NULL) {
+        if (IS_OBJ(*value)) MSCPushRoot(vm->gc, AS_OBJ(*value));
+        wakeWaiter(vm, sender, sender->value, false);
+        if (IS_OBJ(*value)) MSCPopRoot(vm->gc);
+    }
+    return true;
 }
 
-DEF_PRIMITIVE(list_count) {
-    RETURN_NUM(AS_LIST(args[0])->elements.count);
+DEF_PRIMITIVE(channel_receive) {
+    Value value;
+    if (receiveNow(vm, AS_CHANNEL(args[0]), &value)) RETURN_VAL(value);
+    return parkOnChannel(vm, &AS_CHANNEL(args[0])->receivers, NULL_VAL);
 }
 
-DEF_PRIMITIVE(list_insert) {
-    List *list = AS_LIST(args[0]);
-
-    // count + 1 here so you can "insert" at the very end.
-    uint32_t index = validateIndex(vm, args[1], (uint32_t) list->elements.count + 1, "Index");
-    if (index == UINT32_MAX) return false;
+// Receives from the first of a list of channels with a value, or waits for
+// one, and returns its position and the value.
+DEF_PRIMITIVE(channel_select) {
+    if (!IS_LIST(args[1])) RETURN_ERROR("Argument must be a list of Kanali.");
+    List *channels = AS_LIST(args[1]);
+    if (channels->elements.count == 0) RETURN_ERROR("Argument must not be empty.");
+    for (int i = 0; i < channels->elements.count; i++) {
+        if (!IS_CHANNEL(channels->elements.data[i])) {
+            RETURN_ERROR("Argument must be a list of Kanali.");
+        }
+    }
 
-    MSCListInsert(list, vm, args[2], index);
-    RETURN_VAL(args[2]);
-}
+    for (int i = 0; i < channels->elements.count; i++) {
+        Value value;
+        if (!receiveNow(vm, AS_CHANNEL(channels->elements.data[i]), &value)) continue;
 
-DEF_PRIMITIVE(list_iterate) {
-    List *list = AS_LIST(args[0]);
-    if (!validateInt(vm, args[2], "Step")) return false;
-    int32_t step = (int32_t) AS_NUM(args[2]);
+        if (IS_OBJ(value)) MSCPushRoot(vm->gc, AS_OBJ(value));
+        List *pair = MSCListFrom(vm, 2);
+        pair->elements.data[0] = NUM_VAL(i);
+        pair->elements.data[1] = value;
+        if (IS_OBJ(value)) MSCPopRoot(vm->gc);
+        RETURN_OBJ(pair);
+    }
 
-    // If we're starting the iteration, return the first index.
-    if (IS_NULL(args[1])) {
-        if (list->elements.count == 0) RETURN_FALSE;
+    // Park on all of them, in a ring so the first to wake the djuru frees the
+    // others. Allocate them all before any is linked.
+    ChannelWaiter *first = NULL;
+    ChannelWaiter *last = NULL;
+    for (int i = 0; i < channels->elements.count; i++) {
+        ChannelWaiter *waiter = ALLOCATE(vm, ChannelWaiter);
+        waiter->djuru = vm->djuru;
+        waiter->value = NULL_VAL;
+        waiter->index = i;
+        if (first == NULL) first = waiter;
+        else last->nextInSelect = waiter;
+        last = waiter;
+    }
+    last->nextInSelect = first;
 
-        if (step > 0) RETURN_NUM(0);
-        else
-            RETURN_NUM(list->elements.count - 1);
+    ChannelWaiter *waiter = first;
+    for (int i = 0; i < channels->elements.count; i++) {
+        MSCChannelEnqueue(&AS_CHANNEL(channels->elements.data[i])->receivers, waiter);
+        waiter = waiter->nextInSelect;
     }
 
-    if (!validateInt(vm, args[1], "Iterator")) return false;
+    vm->djuru->stackTop--;
+    vm->djuru = NULL;
+    vm->apiStack = NULL;
+    return false;
+}
 
-    // Stop if we're out of bounds.
-    double index = AS_NUM(args[1]);
-    // double absIndex = step > 0 ? index: -index;
-    if ((step > 0 && (index < 0 || index >= list->elements.count - 1)) || (step < 0 && (index < 1 || index > list->elements.count - 1))) RETURN_FALSE;
+DEF_PRIMITIVE(channel_close) {
+    Channel *channel = AS_CHANNEL(args[0]);
+    if (channel->closed) RETURN_NULL;
+    channel->closed = true;
 
-    // Otherwise, move to the next index.
-    RETURN_NUM(index + step);
+    // Receivers only park on an empty channel, so they get null. Senders fail.
+    while (channel->receivers.head != NULL) {
+        wakeWaiter(vm, channel->receivers.head, NULL_VAL, false);
+    }
+    if (channel->senders.head != NULL) {
+        Value error = CONST_STRING(vm, "Can't send to a closed Kanali.");
+        MSCPushRoot(vm->gc, AS_OBJ(error));
+        while (channel->senders.head != NULL) {
+            wakeWaiter(vm, channel->senders.head, error, true);
+        }
+        MSCPopRoot(vm->gc);
+    }
+    RETURN_NULL;
 }
 
-DEF_PRIMITIVE(list_iteratorValue) {
-    List *list = AS_LIST(args[0]);
-    uint32_t index = validateIndex(vm, args[1], (uint32_t) list->elements.count, "Iterator");
-    if (index == UINT32_MAX) return false;
-    RETURN_VAL(list->elements.data[index]);
+DEF_PRIMITIVE(channel_count) {
+    RETURN_NUM(AS_CHANNEL(args[0])->count);
 }
 
-DEF_PRIMITIVE(list_removeAt) {
-    List *list = AS_LIST(args[0]);
-    uint32_t index = validateIndex(vm, args[1], (uint32_t) list->elements.count, "Index");
-    if (index == UINT32_MAX) return false;
+DEF_PRIMITIVE(channel_capacity) {
+    RETURN_NUM(AS_CHANNEL(args[0])->capacity);
+}
 
-    RETURN_VAL(MSCListRemoveAt(list, vm, index));
+DEF_PRIMITIVE(channel_isClosed) {
+    RETURN_BOOL(AS_CHANNEL(args[0])->closed);
 }
 
-DEF_PRIMITIVE(list_removeValue) {
-    List *list = AS_LIST(args[0]);
-    int index = MSCListIndexOf(list, vm, args[1]);
-    if (index == -1) RETURN_NULL;
-    RETURN_VAL(MSCListRemoveAt(list, vm, index));
+// Resumes the generator until it produces its next value, which
+// iteratorValue(_) then returns. The iterator is not used, since a generator
+// can only be iterated once.
+DEF_PRIMITIVE(generator_iterate) {
+    Generator *generator = AS_GENERATOR(args[0]);
+    if (generator->state == GENERATOR_DONE) RETURN_FALSE;
+    if (generator->state == GENERATOR_RUNNING) RETURN_ERROR("Can't resume a running Labolan.");
+
+    vm->djuru->stackTop = args + 1;
+    resumeGenerator(vm, vm->djuru, generator);
+    return false;
 }
 
-DEF_PRIMITIVE(list_indexOf) {
-    List *list = AS_LIST(args[0]);
-    RETURN_NUM(MSCListIndexOf(list, vm, args[1]));
+DEF_PRIMITIVE(generator_iteratorValue) {
+    RETURN_VAL(AS_GENERATOR(args[0])->value);
 }
 
-DEF_PRIMITIVE(list_swap) {
-    List *list = AS_LIST(args[0]);
-    uint32_t indexA = validateIndex(vm, args[1], (uint32_t) list->elements.count, "Index 0");
-    if (indexA == UINT32_MAX) return false;
-    uint32_t indexB = validateIndex(vm, args[2], (uint32_t) list->elements.count, "Index 1");
-    if (indexB == UINT32_MAX) return false;
+DEF_PRIMITIVE(generator_isDone) {
+    RETURN_BOOL(AS_GENERATOR(args[0])->state == GENERATOR_DONE);
+}
 
-    Value a = list->elements.data[indexA];
-    list->elements.data[indexA] = list->elements.data[indexB];
-    list->elements.data[indexB] = a;
+DEF_PRIMITIVE(typedArray_new) {
+    Class *classObj = AS_CLASS(args[0]);
+    TypedArrayKind kind = TYPED_UINT8;
+    if (classObj == vm->core.float64ArrayClass) kind = TYPED_FLOAT64;
+    else if (classObj == vm->core.int32ArrayClass) kind = TYPED_INT32;
 
-    RETURN_NULL;
+    if (IS_NUM(args[1])) {
+        if (!validateInt(vm, args[1], "Size")) return false;
+        double size = AS_NUM(args[1]);
+        if (size < 0) RETURN_ERROR("Size cannot be negative.");
+        if (size > UINT32_MAX / MSCTypedArrayElementSize(kind)) RETURN_ERROR("Size is too large.");
+        RETURN_OBJ(MSCTypedArrayFrom(vm, kind, (uint32_t) size));
+    }
+
+    if (IS_LIST(args[1])) {
+        List *list = AS_LIST(args[1]);
+        for (int i = 0; i < list->elements.count; i++) {
+            if (!validateNum(vm, list->elements.data[i], "Element")) return false;
+        }
+
+        TypedArray *array = MSCTypedArrayFrom(vm, kind, (uint32_t) list->elements.count);
+        for (uint32_t i = 0; i < array->count; i++) {
+            MSCTypedArraySet(array, i, AS_NUM(list->elements.data[i]));
+        }
+        RETURN_OBJ(array);
+    }
+
+    if (IS_TYPED_ARRAY(args[1])) {
+        TypedArray *source = AS_TYPED_ARRAY(args[1]);
+        TypedArray *array = MSCTypedArrayFrom(vm, kind, source->count);
+        if (source->kind == kind) {
+            memcpy(array->data, source->data, MSCTypedArrayElementSize(kind) * source->count);
+        } else {
+            for (uint32_t i = 0; i < array->count; i++) {
+                MSCTypedArraySet(array, i, MSCTypedArrayGet(source, i));
+            }
+        }
+        RETURN_OBJ(array);
+    }
+
+    // A Uint8Walan can hold the bytes of a string.
+    if (IS_STRING(args[1]) && kind == TYPED_UINT8) {
+        String *string = AS_STRING(args[1]);
+        TypedArray *array = MSCTypedArrayFrom(vm, kind, string->length);
+        memcpy(array->data, string->value, string->length);
+        RETURN_OBJ(array);
+    }
+
+    RETURN_ERROR("Source must be a size, a list or a typed array.");
 }
 
-DEF_PRIMITIVE(list_subscript) {
-    List *list = AS_LIST(args[0]);
+DEF_PRIMITIVE(typedArray_subscript) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
 
     if (IS_NUM(args[1])) {
-        uint32_t index = validateIndex(vm, args[1], (uint32_t) list->elements.count,
-                                       "Subscript");
+        uint32_t index = validateIndex(vm, args[1], array->count, "Subscript");
         if (index == UINT32_MAX) return false;
 
-        RETURN_VAL(list->elements.data[index]);
+        RETURN_NUM(MSCTypedArrayGet(array, index));
     }
     if (!IS_RANGE(args[1])) {
         RETURN_ERROR("Subscript must be a number or a range.");
     }
 
     int step;
-    uint32_t count = (uint32_t) list->elements.count;
+    uint32_t count = array->count;
     uint32_t start = calculateRange(vm, AS_RANGE(args[1]), &count, &step);
     if (start == UINT32_MAX) return false;
 
-    List *result = MSCListFrom(vm, count);
-    for (uint32_t i = 0; i < count; i++) {
-        result->elements.data[i] = list->elements.data[start + i * step];
-    }
-    RETURN_OBJ(result);
+    // A slice is a view over the same storage, so it has to be contiguous.
+    if (step < 0 && count > 1) RETURN_ERROR("Typed array slices must be ascending.");
 
+    RETURN_OBJ(MSCTypedArrayView(vm, array, start, count));
 }
 
-DEF_PRIMITIVE(list_subscriptSetter) {
-    List *list = AS_LIST(args[0]);
-    uint32_t index = validateIndex(vm, args[1], (uint32_t) (list->elements.count),
-                                   "Subscript");
+DEF_PRIMITIVE(typedArray_subscriptSetter) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    uint32_t index = validateIndex(vm, args[1], array->count, "Subscript");
     if (index == UINT32_MAX) return false;
+    if (!validateNum(vm, args[2], "Value")) return false;
 
-    list->elements.data[index] = args[2];
+    MSCTypedArraySet(array, index, AS_NUM(args[2]));
     RETURN_VAL(args[2]);
 }
 
-DEF_PRIMITIVE(map_new) {
-    RETURN_OBJ(MSCMapFrom(vm));
+DEF_PRIMITIVE(typedArray_count) {
+    RETURN_NUM(AS_TYPED_ARRAY(args[0])->count);
 }
 
-DEF_PRIMITIVE(map_subscript) {
-    if (!validateKey(vm, args[1])) return false;
+DEF_PRIMITIVE(typedArray_iterate) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    if (!validateInt(vm, args[2], "Step")) return false;
+    int32_t step = (int32_t) AS_NUM(args[2]);
 
-    Map *map = AS_MAP(args[0]);
-    Value value = MSCMapGet(map, args[1]);
-    if (IS_UNDEFINED(value)) RETURN_NULL;
+    // If we're starting the iteration, return the first index.
+    if (IS_NULL(args[1])) {
+        if (array->count == 0) RETURN_FALSE;
 
-    RETURN_VAL(value);
-}
+        if (step > 0) RETURN_NUM(0);
+        else
+            RETURN_NUM(array->count - 1);
+    }
 
-DEF_PRIMITIVE(map_subscriptSetter) {
-    if (!validateKey(vm, args[1])) return false;
+    if (!validateInt(vm, args[1], "Iterator")) return false;
 
-    MSCMapSet(AS_MAP(args[0]), vm, args[1], args[2]);
-    RETURN_VAL(args[2]);
+    // Stop if we're out of bounds.
+    double index = AS_NUM(args[1]);
+    if ((step > 0 && (index < 0 || index >= (double) array->count - 1)) ||
+        (step < 0 && (index < 1 || index > (double) array->count - 1))) RETURN_FALSE;
+
+    // Otherwise, move to the next index.
+    RETURN_NUM(index + step);
 }
 
-// Adds an entry to the map and then returns the map itself. This is called by
-// the compiler when compiling map literals instead of using [_]=(_) to
-// minimize stack churn.
-DEF_PRIMITIVE(map_addCore) {
-    if (!validateKey(vm, args[1])) return false;
+DEF_PRIMITIVE(typedArray_iteratorValue) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    uint32_t index = validateIndex(vm, args[1], array->count, "Iterator");
+    if (index == UINT32_MAX) return false;
+    RETURN_NUM(MSCTypedArrayGet(array, index));
+}
 
-    MSCMapSet(AS_MAP(args[0]), vm, args[1], args[2]);
+DEF_PRIMITIVE(typedArray_fill) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    if (!validateNum(vm, args[1], "Value")) return false;
 
-    // Return the map itself.
-    RETURN_VAL(args[0]);
-}
+    if (array->count == 0) RETURN_VAL(args[0]);
 
-DEF_PRIMITIVE(map_addAllCore) {
-    Map *map = AS_MAP(args[0]);
-    if (!IS_MAP(args[1])) {
-        RETURN_ERROR("Only map can be spread in an other map");
+    // Convert the value once, then replicate its bytes.
+    MSCTypedArraySet(array, 0, AS_NUM(args[1]));
+    switch (array->kind) {
+        case TYPED_FLOAT64: {
+            double *data = (double *) array->data;
+            for (uint32_t i = 1; i < array->count; i++) data[i] = data[0];
+            break;
+        }
+        case TYPED_INT32: {
+            int32_t *data = (int32_t *) array->data;
+            for (uint32_t i = 1; i < array->count; i++) data[i] = data[0];
+            break;
+        }
+        case TYPED_UINT8: {
+            uint8_t *data = (uint8_t *) array->data;
+            memset(data + 1, data[0], array->count - 1);
+            break;
+        }
     }
-    Map *other = AS_MAP(args[1]);
-
-    MSCMapAddAll(map, vm, other);
-    // Return the map itself.
     RETURN_VAL(args[0]);
 }
 
-DEF_PRIMITIVE(map_clear) {
-    MSCMapClear(AS_MAP(args[0]), vm);
-    RETURN_NULL;
+DEF_PRIMITIVE(typedArray_sum) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    uint32_t count = array->count;
+
+    switch (array->kind) {
+        case TYPED_FLOAT64: {
+            // Independent accumulators break the dependency between additions
+            // so the loop can be vectorized.
+            const double *data = (const double *) array->data;
+            double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            uint32_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                s0 += data[i];
+                s1 += data[i + 1];
+                s2 += data[i + 2];
+                s3 += data[i + 3];
+            }
+            for (; i < count; i++) s0 += data[i];
+            RETURN_NUM((s0 + s1) + (s2 + s3));
+        }
+        case TYPED_INT32: {
+            const int32_t *data = (const int32_t *) array->data;
+            int64_t sum = 0;
+            for (uint32_t i = 0; i < count; i++) sum += data[i];
+            RETURN_NUM((double) sum);
+        }
+        case TYPED_UINT8: {
+            const uint8_t *data = (const uint8_t *) array->data;
+            uint64_t sum = 0;
+            for (uint32_t i = 0; i < count; i++) sum += data[i];
+            RETURN_NUM((double) sum);
+        }
+    }
+    RETURN_NUM(0);
+}
+
+// Returns the smallest element of [array] if [wantMax] is false, the largest
+// otherwise. [array] must not be empty.
+static double typedArrayExtreme(const TypedArray *array, bool wantMax) {
+    uint32_t count = array->count;
+
+    switch (array->kind) {
+        case TYPED_FLOAT64: {
+            const double *data = (const double *) array->data;
+            double result = data[0];
+            if (wantMax) {
+                for (uint32_t i = 1; i < count; i++) result = data[i] > result ? data[i] : result;
+            } else {
+                for (uint32_t i = 1; i < count; i++) result = data[i] < result ? data[i] : result;
+            }
+            return result;
+        }
+        case TYPED_INT32: {
+            const int32_t *data = (const int32_t *) array->data;
+            int32_t result = data[0];
+            if (wantMax) {
+                for (uint32_t i = 1; i < count; i++) result = data[i] > result ? data[i] : result;
+            } else {
+                for (uint32_t i = 1; i < count; i++) result = data[i] < result ? data[i] : result;
+            }
+            return result;
+        }
+        case TYPED_UINT8: {
+            const uint8_t *data = (const uint8_t *) array->data;
+            uint8_t result = data[0];
+            if (wantMax) {
+                for (uint32_t i = 1; i < count; i++) result = data[i] > result ? data[i] : result;
+            } else {
+                for (uint32_t i = 1; i < count; i++) result = data[i] < result ? data[i] : result;
+            }
+            return result;
+        }
+    }
+    return 0;
 }
 
-DEF_PRIMITIVE(map_containsKey) {
-    if (!validateKey(vm, args[1])) return false;
-
-    RETURN_BOOL(!IS_UNDEFINED(MSCMapGet(AS_MAP(args[0]), args[1])));
+DEF_PRIMITIVE(typedArray_min) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    if (array->count == 0) RETURN_NULL;
+    RETURN_NUM(typedArrayExtreme(array, false));
 }
 
-DEF_PRIMITIVE(map_count) {
-    RETURN_NUM(AS_MAP(args[0])->count);
+DEF_PRIMITIVE(typedArray_max) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    if (array->count == 0) RETURN_NULL;
+    RETURN_NUM(typedArrayExtreme(array, true));
 }
 
-DEF_PRIMITIVE(map_iterate) {
-    Map *map = AS_MAP(args[0]);
-    if (!validateInt(vm, args[2], "Step")) return false;
-    int32_t step = (int32_t) AS_NUM(args[2]);
+// Validates that [arg] is a typed array with as many elements as [array].
+static bool validateTypedArrayOperand(MVM *vm, TypedArray *array, Value arg) {
+    if (!IS_TYPED_ARRAY(arg)) RETURN_ERROR("Right operand must be a typed array.");
+    if (AS_TYPED_ARRAY(arg)->count != array->count) {
+        RETURN_ERROR("Right operand must have the same length.");
+    }
+    return true;
+}
+
+DEF_PRIMITIVE(typedArray_dot) {
+    TypedArray *left = AS_TYPED_ARRAY(args[0]);
+    if (!validateTypedArrayOperand(vm, left, args[1])) return false;
+    TypedArray *right = AS_TYPED_ARRAY(args[1]);
+    uint32_t count = left->count;
+
+    if (left->kind == TYPED_FLOAT64 && right->kind == TYPED_FLOAT64) {
+        const double *a = (const double *) left->data;
+        const double *b = (const double *) right->data;
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        uint32_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            s0 += a[i] * b[i];
+            s1 += a[i + 1] * b[i + 1];
+            s2 += a[i + 2] * b[i + 2];
+            s3 += a[i + 3] * b[i + 3];
+        }
+        for (; i < count; i++) s0 += a[i] * b[i];
+        RETURN_NUM((s0 + s1) + (s2 + s3));
+    }
 
-    if (map->count == 0) RETURN_FALSE;
+    if (left->kind == TYPED_UINT8 && right->kind == TYPED_UINT8) {
+        const uint8_t *a = (const uint8_t *) left->data;
+        const uint8_t *b = (const uint8_t *) right->data;
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < count; i++) sum += (uint32_t) a[i] * b[i];
+        RETURN_NUM((double) sum);
+    }
 
-    // If we're starting the iteration, start at the first or the last used entry.
-    int index = step < 0 ? map->capacity - 1 : 0;
+    double sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += MSCTypedArrayGet(left, i) * MSCTypedArrayGet(right, i);
+    }
+    RETURN_NUM(sum);
+}
+
+typedef enum {
+    TYPED_ADD,
+    TYPED_SUBTRACT,
+    TYPED_MULTIPLY,
+    TYPED_DIVIDE
+} TypedArrayOp;
+
+// Defines [name] as an element-wise loop over arrays of [type], broadcasting
+// [scalar] as the right operand when [b] is NULL. Each element type gets its
+// own loop so the compiler can vectorize it. Int32 arrays are processed as
+// uint32_t so that overflow wraps instead of being undefined.
+#define DEFINE_ELEMENTWISE(name, type)                                           \
+    static void name(TypedArrayOp op, type *restrict out, const type *a,         \
+                     const type *b, type scalar, uint32_t count) {               \
+        switch (op) {                                                            \
+            case TYPED_ADD:                                                      \
+                if (b == NULL) for (uint32_t i = 0; i < count; i++) out[i] = (type) (a[i] + scalar); \
+                else for (uint32_t i = 0; i < count; i++) out[i] = (type) (a[i] + b[i]); \
+                break;                                                           \
+            case TYPED_SUBTRACT:                                                 \
+                if (b == NULL) for (uint32_t i = 0; i < count; i++) out[i] = (type) (a[i] - scalar); \
+                else for (uint32_t i = 0; i < count; i++) out[i] = (type) (a[i] - b[i]); \
+                break;                                                           \
+            case TYPED_MULTIPLY:                                                 \
+                if (b == NULL) for (uint32_t i = 0; i < count; i++) out[i] = (type) (a[i] * scalar); \
+                else for (uint32_t i = 0; i < count; i++) out[i] = (type) (a[i] * b[i]); \
+                break;                                                           \
+            case TYPED_DIVIDE:                                                   \
+                if (b == NULL) for (uint32_t i = 0; i < count; i++) out[i] = (type) (a[i] / scalar); \
+                else for (uint32_t i = 0; i < count; i++) out[i] = (type) (a[i] / b[i]); \
+                break;                                                           \
+        }                                                                        \
+    }
 
-    // Otherwise, start one past the last entry we stopped at or the first entry.
-    if (!IS_NULL(args[1])) {
-        if (!validateInt(vm, args[1], "Iterator")) return false;
+DEFINE_ELEMENTWISE(elementwiseFloat64, double)
+DEFINE_ELEMENTWISE(elementwiseInt32, uint32_t)
+DEFINE_ELEMENTWISE(elementwiseUint8, uint8_t)
 
-        // if (AS_NUM(args[1]) <= 0) RETURN_FALSE;
-        index = (int) AS_NUM(args[1]);
-        if (index < 0 || index >= map->capacity) RETURN_FALSE;
+#undef DEFINE_ELEMENTWISE
 
-        // Advance the iterator.
-        index += step;
+static double applyTypedArrayOp(TypedArrayOp op, double a, double b) {
+    switch (op) {
+        case TYPED_ADD: return a + b;
+        case TYPED_SUBTRACT: return a - b;
+        case TYPED_MULTIPLY: return a * b;
+        case TYPED_DIVIDE: return a / b;
     }
+    return 0;
+}
 
-    // Find a used entry, if any.
-    if (step > 0) {
-        for (; index < map->capacity; index++) {
+// Applies [op] to the typed array in args[0] and the typed array or number in
+// args[1]. The result keeps the left operand's kind when both operands fit in
+// it and is a Float64Walan otherwise. Division always produces a Float64Walan.
+static bool typedArrayArithmetic(MVM *vm, Value *args, TypedArrayOp op) {
+    TypedArray *left = AS_TYPED_ARRAY(args[0]);
+    TypedArray *right = NULL;
+    double scalar = 0;
 
-            if (!IS_UNDEFINED(map->entries[index].key)) {
-                RETURN_NUM(index);
-            }
-        }
+    if (IS_NUM(args[1])) {
+        scalar = AS_NUM(args[1]);
     } else {
-        for (; index >= 0; index--) {
-            if (!IS_UNDEFINED(map->entries[index].key)) RETURN_NUM(index);
+        if (!IS_TYPED_ARRAY(args[1])) RETURN_ERROR("Right operand must be a number or a typed array.");
+        if (!validateTypedArrayOperand(vm, left, args[1])) return false;
+        right = AS_TYPED_ARRAY(args[1]);
+    }
+
+    bool sameKind = right != NULL ? right->kind == left->kind
+                                  : left->kind == TYPED_FLOAT64 || trunc(scalar) == scalar;
+    TypedArrayKind kind = TYPED_FLOAT64;
+    if (sameKind && (op != TYPED_DIVIDE || left->kind == TYPED_FLOAT64)) kind = left->kind;
+
+    uint32_t count = left->count;
+    TypedArray *result = MSCTypedArrayFrom(vm, kind, count);
+
+    if (kind == left->kind && sameKind) {
+        const void *b = right != NULL ? right->data : NULL;
+        switch (kind) {
+            case TYPED_FLOAT64:
+                elementwiseFloat64(op, (double *) result->data, (const double *) left->data,
+                                   (const double *) b, scalar, count);
+                break;
+            case TYPED_INT32:
+                elementwiseInt32(op, (uint32_t *) result->data, (const uint32_t *) left->data,
+                                 (const uint32_t *) b, right != NULL ? 0 : MSCNumToUint32(scalar), count);
+                break;
+            case TYPED_UINT8:
+                elementwiseUint8(op, (uint8_t *) result->data, (const uint8_t *) left->data,
+                                 (const uint8_t *) b, (uint8_t) (right != NULL ? 0 : MSCNumToUint32(scalar)), count);
+                break;
         }
+        RETURN_OBJ(result);
     }
 
-    // If we get here, walked all of the entries.
-    RETURN_FALSE;
+    for (uint32_t i = 0; i < count; i++) {
+        double b = right != NULL ? MSCTypedArrayGet(right, i) : scalar;
+        MSCTypedArraySet(result, i, applyTypedArrayOp(op, MSCTypedArrayGet(left, i), b));
+    }
+    RETURN_OBJ(result);
 }
 
-DEF_PRIMITIVE(map_remove) {
-    if (!validateKey(vm, args[1])) return false;
+DEF_PRIMITIVE(typedArray_plus) {
+    return typedArrayArithmetic(vm, args, TYPED_ADD);
+}
 
-    RETURN_VAL(MSCMapRemove(AS_MAP(args[0]), vm, args[1]));
+DEF_PRIMITIVE(typedArray_minus) {
+    return typedArrayArithmetic(vm, args, TYPED_SUBTRACT);
 }
 
-DEF_PRIMITIVE(map_keyIteratorValue) {
-    Map *map = AS_MAP(args[0]);
-    uint32_t index = validateIndex(vm, args[1], map->capacity, "Iterator");
-    if (index == UINT32_MAX) return false;
+DEF_PRIMITIVE(typedArray_multiply) {
+    return typedArrayArithmetic(vm, args, TYPED_MULTIPLY);
+}
 
-    MapEntry *entry = &map->entries[index];
-    if (IS_UNDEFINED(entry->key)) {
-        RETURN_ERROR("Invalid map iterator.");
+DEF_PRIMITIVE(typedArray_divide) {
+    return typedArrayArithmetic(vm, args, TYPED_DIVIDE);
+}
+
+// Uint8Walan doubles as a byte buffer. Multi-byte numbers are read and written
+// at any byte offset, in little-endian order when the last argument is true
+// and big-endian order otherwise.
+static uint8_t *validateByteOffset(MVM *vm, TypedArray *array, Value arg, uint32_t size) {
+    if (!validateInt(vm, arg, "Offset")) return NULL;
+
+    double offset = AS_NUM(arg);
+    if (offset < 0 || offset + size > array->count) {
+        vm->djuru->error = CONST_STRING(vm, "Offset out of bounds.");
+        return NULL;
     }
+    return (uint8_t *) array->data + (uint32_t) offset;
+}
 
-    RETURN_VAL(entry->key);
+static uint64_t readBytes(const uint8_t *bytes, uint32_t size, bool littleEndian) {
+    uint64_t bits = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        bits = (bits << 8) | bytes[littleEndian ? size - 1 - i : i];
+    }
+    return bits;
 }
 
-DEF_PRIMITIVE(map_valueIteratorValue) {
-    Map *map = AS_MAP(args[0]);
-    uint32_t index = validateIndex(vm, args[1], map->capacity, "Iterator");
-    if (index == UINT32_MAX) return false;
+static void writeBytes(uint8_t *bytes, uint32_t size, uint64_t bits, bool littleEndian) {
+    for (uint32_t i = 0; i < size; i++) {
+        bytes[littleEndian ? i : size - 1 - i] = (uint8_t) (bits & 0xff);
+        bits >>= 8;
+    }
+}
 
-    MapEntry *entry = &map->entries[index];
-    if (IS_UNDEFINED(entry->key)) {
-        RETURN_ERROR("Invalid map iterator.");
+static inline double bitsToFloat32(uint64_t bits) {
+    uint32_t narrow = (uint32_t) bits;
+    float value;
+    memcpy(&value, &narrow, sizeof(value));
+    return value;
+}
+
+static inline double bitsToFloat64(uint64_t bits) {
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static inline uint64_t float32ToBits(double number) {
+    float value = (float) number;
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline uint64_t float64ToBits(double number) {
+    uint64_t bits;
+    memcpy(&bits, &number, sizeof(bits));
+    return bits;
+}
+
+#define INT_TO_BITS(number) ((uint64_t) MSCNumToUint32(number))
+
+// Defines the get[Name] and set[Name] primitives for a number of [size] bytes.
+// [FROM_BITS] turns the bytes read into a double and [TO_BITS] does the
+// reverse.
+#define DEFINE_BYTE_ACCESSORS(name, size, FROM_BITS, TO_BITS)                  \
+    DEF_PRIMITIVE(bytes_get##name) {                                           \
+        TypedArray *array = AS_TYPED_ARRAY(args[0]);                           \
+        uint8_t *bytes = validateByteOffset(vm, array, args[1], size);         \
+        if (bytes == NULL) return false;                                       \
+        bool littleEndian = size > 1 && !isFalsyValue(args[2]);                \
+        uint64_t bits = readBytes(bytes, size, littleEndian);                  \
+        RETURN_NUM(FROM_BITS(bits));                                           \
+    }                                                                          \
+                                                                               \
+    DEF_PRIMITIVE(bytes_set##name) {                                           \
+        TypedArray *array = AS_TYPED_ARRAY(args[0]);                           \
+        uint8_t *bytes = validateByteOffset(vm, array, args[1], size);         \
+        if (bytes == NULL) return false;                                       \
+        if (!validateNum(vm, args[2], "Value")) return false;                  \
+        bool littleEndian = size > 1 && !isFalsyValue(args[3]);                \
+        writeBytes(bytes, size, TO_BITS(AS_NUM(args[2])), littleEndian);      \
+        RETURN_VAL(args[2]);                                                   \
     }
-    RETURN_VAL(entry->value);
+
+DEFINE_BYTE_ACCESSORS(Int8, 1, (int8_t), INT_TO_BITS)
+DEFINE_BYTE_ACCESSORS(Uint8, 1, (uint8_t), INT_TO_BITS)
+DEFINE_BYTE_ACCESSORS(Int16, 2, (int16_t), INT_TO_BITS)
+DEFINE_BYTE_ACCESSORS(Uint16, 2, (uint16_t), INT_TO_BITS)
+DEFINE_BYTE_ACCESSORS(Int32, 4, (int32_t), INT_TO_BITS)
+DEFINE_BYTE_ACCESSORS(Uint32, 4, (uint32_t), INT_TO_BITS)
+DEFINE_BYTE_ACCESSORS(Float32, 4, bitsToFloat32, float32ToBits)
+DEFINE_BYTE_ACCESSORS(Float64, 8, bitsToFloat64, float64ToBits)
+
+#undef INT_TO_BITS
+#undef DEFINE_BYTE_ACCESSORS
+
+// Copies the bytes of a string or another Uint8Walan into the buffer at
+// [offset]. The two may share storage.
+DEF_PRIMITIVE(bytes_copy) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    const void *source;
+    uint32_t length;
+    if (IS_STRING(args[2])) {
+        source = AS_STRING(args[2])->value;
+        length = AS_STRING(args[2])->length;
+    } else if (IS_TYPED_ARRAY(args[2]) && AS_TYPED_ARRAY(args[2])->kind == TYPED_UINT8) {
+        source = AS_TYPED_ARRAY(args[2])->data;
+        length = AS_TYPED_ARRAY(args[2])->count;
+    } else {
+        RETURN_ERROR("Source must be a string or a Uint8Walan.");
+    }
+
+    uint8_t *bytes = validateByteOffset(vm, array, args[1], length);
+    if (bytes == NULL) return false;
+    memmove(bytes, source, length);
+    RETURN_NUM(length);
+}
+
+DEF_PRIMITIVE(bytes_toString) {
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    RETURN_VAL(MSCStringFromCharsWithLength(vm, (const char *) array->data, array->count));
+}
+
+// Binds the primitives shared by every typed array class to [classObj].
+static void bindTypedArrayPrimitives(MVM *vm, Class *classObj) {
+    PRIMITIVE(classObj->obj.classObj, "kura(_)", typedArray_new);
+    PRIMITIVE(classObj, "[_]", typedArray_subscript);
+    PRIMITIVE(classObj, "[_]=(_)", typedArray_subscriptSetter);
+    PRIMITIVE(classObj, "hakan", typedArray_count);
+    PRIMITIVE(classObj, "iterate(_,_)", typedArray_iterate);
+    PRIMITIVE(classObj, "iteratorValue(_)", typedArray_iteratorValue);
+    PRIMITIVE(classObj, "fill(_)", typedArray_fill);
+    PRIMITIVE(classObj, "sum", typedArray_sum);
+    PRIMITIVE(classObj, "min", typedArray_min);
+    PRIMITIVE(classObj, "max", typedArray_max);
+    PRIMITIVE(classObj, "dot(_)", typedArray_dot);
+    PRIMITIVE(classObj, "+(_)", typedArray_plus);
+    PRIMITIVE(classObj, "-(_)", typedArray_minus);
+    PRIMITIVE(classObj, "*(_)", typedArray_multiply);
+    PRIMITIVE(classObj, "/(_)", typedArray_divide);
 }
 
 DEF_PRIMITIVE(null_not) {
@@ -596,9 +2388,25 @@ DEF_PRIMITIVE(num_fromString) {
     // Corner case: Can't parse an empty string.
     if (string->length == 0) RETURN_NULL;
 
+    // Plain decimal numbers, by far the most common, don't need strtod().
+    const char *start = string->value;
+    while (isspace((unsigned char) *start)) start++;
+    size_t remaining = string->length - (size_t) (start - string->value);
+    double number;
+    size_t read = MSCDoubleFromChars(start, remaining, &number);
+    if (read > 0) {
+        const char *end = start + read;
+        while (*end != '\0' && isspace((unsigned char) *end)) end++;
+        if (end == string->value + string->length) {
+            if (isinf(number)) RETURN_ERROR("Number literal is too large.");
+            RETURN_NUM(number);
+        }
+    }
+
+    // Let strtod() handle the other forms it knows, like hexadecimal.
     errno = 0;
     char *end;
-    double number = strtod(string->value, &end);
+    number = strtod(string->value, &end);
 
     // Skip past any trailing whitespace.
     while (*end != '\0' && isspace((unsigned char) *end)) end++;
@@ -1293,6 +3101,8 @@ void load(MVM *vm) {
     PRIMITIVE(vm->core.djuruClass->obj.classObj, "djo()", djuru_suspend);
     PRIMITIVE(vm->core.djuruClass->obj.classObj, "mine()", djuru_yield);
     PRIMITIVE(vm->core.djuruClass->obj.classObj, "mine(_)", djuru_yield1);
+    PRIMITIVE(vm->core.djuruClass->obj.classObj, "bila(_)", djuru_spawn);
+    PRIMITIVE(vm->core.djuruClass->obj.classObj, "sunogo(_)", djuru_sleep);
     PRIMITIVE(vm->core.djuruClass, "weele()", djuru_call);
     PRIMITIVE(vm->core.djuruClass, "weele(_)", djuru_call1);
     PRIMITIVE(vm->core.djuruClass, "fili", djuru_error);
@@ -1302,6 +3112,8 @@ void load(MVM *vm) {
     PRIMITIVE(vm->core.djuruClass, "filiLaTeme(_)", djuru_transferError);
     PRIMITIVE(vm->core.djuruClass, "aladie()", djuru_try);
     PRIMITIVE(vm->core.djuruClass, "aladie(_)", djuru_try1);
+    PRIMITIVE(vm->core.djuruClass, "bila()", djuru_schedule);
+    PRIMITIVE(vm->core.djuruClass, "makono()", djuru_join);
 
     vm->core.fnClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Tii"));
     PRIMITIVE(vm->core.fnClass->obj.classObj, "kura(_)", fn_new);
@@ -1432,6 +3244,16 @@ void load(MVM *vm) {
     PRIMITIVE(vm->core.listClass, "aBoye(_)", list_removeValue);
     PRIMITIVE(vm->core.listClass, "aDayoro(_)", list_indexOf);
     PRIMITIVE(vm->core.listClass, "falen(_,_)", list_swap);// swap
+    PRIMITIVE(vm->core.listClass, "wolomaDefault_()", list_sortDefault);
+    PRIMITIVE(vm->core.listClass, "bAkono_(_)", list_contains);
+    PRIMITIVE(vm->core.listClass, "walanNa", list_toList);
+    PRIMITIVE(vm->core.listClass, "faraWalan_(_)", list_concat);
+    PRIMITIVE(vm->core.listClass, "*(_)", list_repeat);
+    PRIMITIVE(vm->core.listClass, "kunBen_(_)", list_join);
+    PRIMITIVE(vm->core.listClass, "fara_", list_sum);
+    PRIMITIVE(vm->core.listClass, "min_", list_min);
+    PRIMITIVE(vm->core.listClass, "max_", list_max);
+    PRIMITIVE(vm->core.listClass, "kelenya_", list_distinct);
 
     vm->core.mapClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Wala"));
     PRIMITIVE(vm->core.mapClass->obj.classObj, "kura()", map_new);
@@ -1447,6 +3269,94 @@ void load(MVM *vm) {
     PRIMITIVE(vm->core.mapClass, "keyIteratorValue_(_)", map_keyIteratorValue);
     PRIMITIVE(vm->core.mapClass, "valueIteratorValue_(_)", map_valueIteratorValue);
 
+    vm->core.setClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Jekulu"));
+    PRIMITIVE(vm->core.setClass->obj.classObj, "kura()", set_new);
+    PRIMITIVE(vm->core.setClass, "aFaraAkan(_)", set_add);
+    PRIMITIVE(vm->core.setClass, "diossi()", set_clear);
+    PRIMITIVE(vm->core.setClass, "bAkono(_)", set_contains);
+    PRIMITIVE(vm->core.setClass, "hakan", set_count);
+    PRIMITIVE(vm->core.setClass, "aBoye(_)", set_remove);
+    PRIMITIVE(vm->core.setClass, "iterate(_,_)", set_iterate);
+    PRIMITIVE(vm->core.setClass, "iteratorValue(_)", set_iteratorValue);
+    PRIMITIVE(vm->core.setClass, "|(_)", set_union);
+    PRIMITIVE(vm->core.setClass, "&(_)", set_intersection);
+    PRIMITIVE(vm->core.setClass, "-(_)", set_difference);
+
+    vm->core.dequeClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Layini"));
+    PRIMITIVE(vm->core.dequeClass->obj.classObj, "kura()", deque_new);
+    PRIMITIVE(vm->core.dequeClass, "aFaraAkan(_)", deque_pushBack);
+    PRIMITIVE(vm->core.dequeClass, "aFaraFolo(_)", deque_pushFront);
+    PRIMITIVE(vm->core.dequeClass, "aBoLaban()", deque_popBack);
+    PRIMITIVE(vm->core.dequeClass, "aBoFolo()", deque_popFront);
+    PRIMITIVE(vm->core.dequeClass, "folo", deque_first);
+    PRIMITIVE(vm->core.dequeClass, "laban", deque_last);
+    PRIMITIVE(vm->core.dequeClass, "diossi()", deque_clear);
+    PRIMITIVE(vm->core.dequeClass, "hakan", deque_count);
+    PRIMITIVE(vm->core.dequeClass, "[_]", deque_subscript);
+    PRIMITIVE(vm->core.dequeClass, "[_]=(_)", deque_subscriptSetter);
+    PRIMITIVE(vm->core.dequeClass, "iterate(_,_)", deque_iterate);
+    PRIMITIVE(vm->core.dequeClass, "iteratorValue(_)", deque_iteratorValue);
+
+    vm->core.channelClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Kanali"));
+    PRIMITIVE(vm->core.channelClass->obj.classObj, "kura()", channel_new);
+    PRIMITIVE(vm->core.channelClass->obj.classObj, "kura(_)", channel_newWithCapacity);
+    PRIMITIVE(vm->core.channelClass->obj.classObj, "sugandi(_)", channel_select);
+    PRIMITIVE(vm->core.channelClass, "ci(_)", channel_send);
+    PRIMITIVE(vm->core.channelClass, "soro()", channel_receive);
+    PRIMITIVE(vm->core.channelClass, "datugu()", channel_close);
+    PRIMITIVE(vm->core.channelClass, "datugura", channel_isClosed);
+    PRIMITIVE(vm->core.channelClass, "hakan", channel_count);
+    PRIMITIVE(vm->core.channelClass, "bonya", channel_capacity);
+
+    vm->core.generatorClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Labolan"));
+    PRIMITIVE(vm->core.generatorClass, "iterate(_,_)", generator_iterate);
+    PRIMITIVE(vm->core.generatorClass, "iteratorValue(_)", generator_iteratorValue);
+    PRIMITIVE(vm->core.generatorClass, "ok", generator_isDone);
+
+    vm->core.heapClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Sinsin"));
+    PRIMITIVE(vm->core.heapClass->obj.classObj, "kura()", heap_new);
+    PRIMITIVE(vm->core.heapClass->obj.classObj, "kura(_)", heap_newWithComparer);
+    PRIMITIVE(vm->core.heapClass, "aFaraAkan_(_,_)", heap_push);
+    PRIMITIVE(vm->core.heapClass, "aBoFolo_()", heap_pop);
+    PRIMITIVE(vm->core.heapClass, "sangaDefault_", heap_isNative);
+    PRIMITIVE(vm->core.heapClass, "folo", heap_first);
+    PRIMITIVE(vm->core.heapClass, "hakan", heap_count);
+    PRIMITIVE(vm->core.heapClass, "diossi()", heap_clear);
+    PRIMITIVE(vm->core.heapClass, "sanga_", heap_comparer);
+    PRIMITIVE(vm->core.heapClass, "sira_(_)", heap_priority);
+    PRIMITIVE(vm->core.heapClass, "falen_(_,_)", heap_swap);
+    PRIMITIVE(vm->core.heapClass, "iterate(_,_)", heap_iterate);
+    PRIMITIVE(vm->core.heapClass, "iteratorValue(_)", heap_iteratorValue);
+
+    vm->core.pipelineClass = AS_CLASS(MSCFindVariable(vm, coreModule, "SiraTugun"));
+    PRIMITIVE(vm->core.pipelineClass, "daminen_(_)", pipeline_start);
+    PRIMITIVE(vm->core.pipelineClass, "tambi_(_,_)", pipeline_step);
+
+    vm->core.float64ArrayClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Float64Walan"));
+    bindTypedArrayPrimitives(vm, vm->core.float64ArrayClass);
+    vm->core.int32ArrayClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Int32Walan"));
+    bindTypedArrayPrimitives(vm, vm->core.int32ArrayClass);
+    vm->core.uint8ArrayClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Uint8Walan"));
+    bindTypedArrayPrimitives(vm, vm->core.uint8ArrayClass);
+    PRIMITIVE(vm->core.uint8ArrayClass, "getInt8(_)", bytes_getInt8);
+    PRIMITIVE(vm->core.uint8ArrayClass, "setInt8(_,_)", bytes_setInt8);
+    PRIMITIVE(vm->core.uint8ArrayClass, "getUint8(_)", bytes_getUint8);
+    PRIMITIVE(vm->core.uint8ArrayClass, "setUint8(_,_)", bytes_setUint8);
+    PRIMITIVE(vm->core.uint8ArrayClass, "getInt16(_,_)", bytes_getInt16);
+    PRIMITIVE(vm->core.uint8ArrayClass, "setInt16(_,_,_)", bytes_setInt16);
+    PRIMITIVE(vm->core.uint8ArrayClass, "getUint16(_,_)", bytes_getUint16);
+    PRIMITIVE(vm->core.uint8ArrayClass, "setUint16(_,_,_)", bytes_setUint16);
+    PRIMITIVE(vm->core.uint8ArrayClass, "getInt32(_,_)", bytes_getInt32);
+    PRIMITIVE(vm->core.uint8ArrayClass, "setInt32(_,_,_)", bytes_setInt32);
+    PRIMITIVE(vm->core.uint8ArrayClass, "getUint32(_,_)", bytes_getUint32);
+    PRIMITIVE(vm->core.uint8ArrayClass, "setUint32(_,_,_)", bytes_setUint32);
+    PRIMITIVE(vm->core.uint8ArrayClass, "getFloat32(_,_)", bytes_getFloat32);
+    PRIMITIVE(vm->core.uint8ArrayClass, "setFloat32(_,_,_)", bytes_setFloat32);
+    PRIMITIVE(vm->core.uint8ArrayClass, "getFloat64(_,_)", bytes_getFloat64);
+    PRIMITIVE(vm->core.uint8ArrayClass, "setFloat64(_,_,_)", bytes_setFloat64);
+    PRIMITIVE(vm->core.uint8ArrayClass, "bila(_,_)", bytes_copy);
+    PRIMITIVE(vm->core.uint8ArrayClass, "sebenNa", bytes_toString);
+
     vm->core.rangeClass = AS_CLASS(MSCFindVariable(vm, coreModule, "Funan"));
     PRIMITIVE(vm->core.rangeClass, "kabo", range_from);
     PRIMITIVE(vm->core.rangeClass, "kata", range_to);
@@ -1494,6 +3404,15 @@ void MSCInitCore(Core *core, MVM *vm) {
     core->mapClass = NULL;
     core->nullClass = NULL;
     core->rangeClass = NULL;
+    core->pipelineClass = NULL;
+    core->setClass = NULL;
+    core->dequeClass = NULL;
+    core->heapClass = NULL;
+    core->channelClass = NULL;
+    core->generatorClass = NULL;
+    core->float64ArrayClass = NULL;
+    core->int32ArrayClass = NULL;
+    core->uint8ArrayClass = NULL;
     load(vm);
 }
 
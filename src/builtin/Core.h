@@ -11,16 +11,25 @@
 typedef struct  {
 
     Class * boolClass;
+    Class * channelClass;
     Class * classClass;
+    Class * dequeClass;
     Class * djuruClass;
+    Class * float64ArrayClass;
     Class * fnClass;
+    Class * generatorClass;
+    Class * heapClass;
+    Class * int32ArrayClass;
     Class * listClass;
     Class * mapClass;
     Class * nullClass;
     Class * numClass;
     Class * objectClass;
+    Class * pipelineClass;
     Class * rangeClass;
+    Class * setClass;
     Class * stringClass;
+    Class * uint8ArrayClass;
 
 
 } Core;
@@ -28,5 +37,44 @@ typedef struct  {
 void MSCInitCore(Core* core, MVM* vm);
 Class *defineClass(MVM *vm, Module *module, const char *name);
 
+// The slots of the state list of a SiraTugun iteration. They are followed by
+// what is left to skip or take for each stage.
+typedef enum {
+    PIPELINE_ITERATOR,
+    PIPELINE_VALUE,
+    PIPELINE_STEP,
+    PIPELINE_SEQUENCE,
+    PIPELINE_KINDS,
+    PIPELINE_WAITING,
+    PIPELINE_POSITION,
+    PIPELINE_APPLIED,
+    PIPELINE_STATUS,
+    PIPELINE_COUNTERS
+} PipelineSlot;
+
+// The fields of a SiraTugun, in the order core.msc declares them: the
+// sequence, the kind of each stage, and each stage's closure or count.
+typedef enum {
+    PIPELINE_FIELD_SEQUENCE,
+    PIPELINE_FIELD_KINDS,
+    PIPELINE_FIELD_ARGS
+} PipelineField;
+
+// What a SiraTugun iteration needs next. Otherwise it is the index of the
+// stage whose closure has to be called with the current value.
+typedef enum {
+    PIPELINE_READY = -1,
+    PIPELINE_DONE = -2,
+    PIPELINE_ITERATE = -3,
+    PIPELINE_ITERATOR_VALUE = -4
+} PipelineStep;
+
+// Creates the state list to iterate the SiraTugun [pipeline] by [step].
+List *MSCPipelineStart(MVM *vm, Value pipeline, Value step);
+
+// Runs the stages of a SiraTugun iteration, taking [answer] as the result of
+// the call asked for by the previous step, until the next call is needed.
+int MSCPipelineStep(Value *state, Value answer);
+
 
 #endif //CPMSC_CORE_H
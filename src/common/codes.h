@@ -119,3 +119,39 @@ OPCODE(FIELD, 0)                 // = 78
 OPCODE(END , 0)                 // = 79
 
 OPCODE(LOAD_ON , 1)              // = 80
+
+// Steps a `seginka` loop natively when the sequence's iterate(_,_) and
+// iteratorValue(_) methods are primitives, and runs SiraTugun pipelines by
+// calling their stage functions directly. Otherwise falls through to the
+// generic calls that follow it.
+OPCODE(FOR_ITER , 0)            // = 81
+
+// Skips the code that builds the range of a `seginka a..b` loop when both
+// bounds are numbers, and Diat's range operator and Funan's iteration methods
+// are still the built-in ones.
+OPCODE(FOR_RANGE_INIT , 0)      // = 82
+
+// Counts a `seginka a..b` loop over its unboxed bounds. Falls through to the
+// generic calls when the range had to be built.
+OPCODE(FOR_RANGE , 0)           // = 83
+
+// Calls "sebenma" on the top of the stack, unless it is already a string.
+OPCODE(TO_STRING , 0)           // = 84
+
+// Pops the given number of strings and pushes them joined as one string. The
+// compiler tracks its stack effect, which depends on that number.
+OPCODE(INTERPOLATE , 0)         // = 85
+
+// The first instruction of a `tii*` function. Pushes a generator holding the
+// frame's arguments, which the RETURN after it hands to the caller. The
+// generator resumes after that RETURN.
+OPCODE(GENERATOR , 1)           // = 86
+
+// Suspends the generator running in this frame with the value on top of the
+// stack as the one it produces, and returns `tien` to the code resuming it.
+// The `labo` expression is null when the generator resumes.
+OPCODE(YIELD , 0)               // = 87
+
+// Ends the generator running in this frame, and returns `galon` to the code
+// resuming it.
+OPCODE(GENERATOR_END , 0)       // = 88
@@ -35,6 +35,24 @@
 #define MSC_OPT_KUNFE 1
 #endif
 
+// The file module needs POSIX files and memory mapping.
+#ifndef MSC_OPT_GAFE
+#if defined(_WIN32)
+#define MSC_OPT_GAFE 0
+#else
+#define MSC_OPT_GAFE 1
+#endif
+#endif
+
+// The sockets module needs epoll.
+#ifndef MSC_OPT_SOKITI
+#if defined(__linux__)
+#define MSC_OPT_SOKITI 1
+#else
+#define MSC_OPT_SOKITI 0
+#endif
+#endif
+
 
 #define MSC_DEBUG_TRACE_GC 0
 
@@ -16,10 +16,31 @@
 #define MAX_MODULE_VARS 1 << 16
 #define ERROR_MESSAGE_SIZE 80 + MAX_VARIABLE_NAME + 15
 #define MAX_FIELDS 1 << 16
-#define MAP_LOAD_PERCENT 90
+#define MAP_LOAD_PERCENT 87
 #define MAP_GROW_FACTOR 2
 #define LIST_GROW_FACTOR 2
 #define MAP_MIN_CAPACITY 16
+#define MAP_MIN_ENTRIES 4
+// Number of control bytes matched at once when probing a map.
+#define MAP_GROUP_WIDTH 16
+// The smallest ring buffer a deque allocates. Must be a power of two.
+#define DEQUE_MIN_CAPACITY 8
+// The number of threads running the blocking operations djurus wait for, like
+// reading a file.
+#define ASYNC_THREADS 2
+// The call frames a djuru starts with.
+#define INITIAL_CALL_FRAMES 4
+// The stack slots a small djuru keeps in the same allocation as itself. Must
+// be a power of two.
+#define DJURU_INLINE_SLOTS 16
+// A VM keeps the memory of collected djurus to build new ones with, up to
+// DJURU_POOL_BYTES in all. Stacks and frame arrays are kept by capacity, up to
+// 2^(DJURU_POOL_BUCKETS - 1).
+#define DJURU_POOL_BYTES (4 << 20)
+#define DJURU_POOL_BUCKETS 10
+// While a call from the host has a deadline, the clock is read at every
+// DEADLINE_POLLS-th loop back-edge or call.
+#define DEADLINE_POLLS 1024
 // #define CLOCKS_PER_SEC 1000
 
 // The maximum name of a method, not including the signature. This is an
@@ -261,6 +261,9 @@ struct Compiler {
     // Whether or not the compiler is for a constructor initializer
     bool isInitializer;
 
+    // Whether or not the compiler is for a `tii*` function.
+    bool isGenerator;
+
     bool isExtension;
 
     TokenType dotSource;
@@ -353,10 +356,14 @@ static void whenExpression(Compiler *compiler, bool canAssign);
 
 static void ifExpression(Compiler *compiler, bool canAssign);
 
+static void yieldExpression(Compiler *compiler, bool canAssign);
+
 static void ignoreNewlines(Compiler *compiler);
 
 static void parsePrecedence(Compiler *compiler, Precedence precedence);
 
+static void infixOperators(Compiler *compiler, Precedence precedence, bool canAssign);
+
 static bool statement(Compiler *compiler, bool expr);
 
 static bool definition(Compiler *compiler, bool expr);
@@ -379,6 +386,7 @@ static void initCompiler(Compiler *compiler, Parser *parser, Compiler *parent,
     compiler->loop = NULL;
     compiler->enclosingClass = NULL;
     compiler->isInitializer = false;
+    compiler->isGenerator = false;
     compiler->isExtension = false;
 
     // Initialize these to NULL before allocating in case a GC gets triggered in
@@ -702,6 +710,9 @@ static int getByteCountForArguments(const uint8_t *bytecode,
         case OP_CLOSE_UPVALUE:
         case OP_RETURN:
         case OP_END:
+        case OP_GENERATOR:
+        case OP_YIELD:
+        case OP_GENERATOR_END:
         case OP_LOAD_LOCAL_0:
         case OP_LOAD_LOCAL_1:
         case OP_LOAD_LOCAL_2:
@@ -728,6 +739,7 @@ static int getByteCountForArguments(const uint8_t *bytecode,
         case OP_STORE_FIELD:
         case OP_FIELD:
         case OP_CLASS:
+        case OP_INTERPOLATE:
             return 1;
 
         case OP_CONSTANT:
@@ -760,6 +772,7 @@ static int getByteCountForArguments(const uint8_t *bytecode,
         case OP_METHOD_STATIC:
         case OP_IMPORT_MODULE:
         case OP_IMPORT_VARIABLE:
+        case OP_TO_STRING:
             return 2;
 
         case OP_SUPER_0:
@@ -781,6 +794,15 @@ static int getByteCountForArguments(const uint8_t *bytecode,
         case OP_SUPER_16:
             return 4;
 
+        case OP_FOR_ITER:
+            return 9;
+
+        case OP_FOR_RANGE_INIT:
+            return 9;
+
+        case OP_FOR_RANGE:
+            return 6;
+
         case OP_CLOSURE: {
             int constant = (bytecode[ip + 1] << 8) | bytecode[ip + 2];
             Function *loadedFn = AS_FUNCTION(constants[constant]);
@@ -1752,6 +1774,18 @@ static bool finishBlock(Compiler *compiler, bool expr) {
 // If [Compiler->isInitializer] is `true`, this is the body of a constructor
 // initializer. In that case, this adds the code to ensure it returns `this`.
 static void finishBody(Compiler *compiler) {
+    if (compiler->isGenerator) {
+        // Calling the function only creates the generator. The RETURN takes it
+        // off the stack again.
+        emitOp(compiler, OP_GENERATOR);
+        emitOp(compiler, OP_RETURN);
+        compiler->numSlots--;
+
+        if (finishBlock(compiler, false)) emitOp(compiler, OP_POP);
+        emitOp(compiler, OP_GENERATOR_END);
+        return;
+    }
+
     bool isExpressionBody = finishBlock(compiler, false);
 
     if (compiler->isInitializer) {
@@ -1780,6 +1814,8 @@ static int signatureSymbol(Compiler *compiler, Signature *signature) {
 }
 
 static void functionDefinition(Compiler *compiler, bool isStatic) {
+    // `tii*` defines a generator.
+    bool isGenerator = match(compiler, MULT_TOKEN);
     // consume(compiler,ID_TOKEN, "Expect variable name.");
     SignatureFn signatureFn = getRule(compiler->parser->current.type)->method;
     nextToken(compiler->parser);
@@ -1815,6 +1851,7 @@ static void functionDefinition(Compiler *compiler, bool isStatic) {
     if (className != NULL) {
         functionCompiler.isExtension = true;
     }
+    functionCompiler.isGenerator = isGenerator;
     // Compile the method signature.
     signatureFn(&functionCompiler, &signature);
 
@@ -1868,6 +1905,15 @@ static void patchJump(Compiler *compiler, int offset) {
     compiler->function->code.data[offset + 1] = (uint8_t) (jump & 0xff);
 }
 
+// Patches the OP_FOR_ITER offset at [offset] to jump from [end], the end of the
+// instruction, to the current end of bytecode.
+static void patchForIter(Compiler *compiler, int offset, int end) {
+    int jump = compiler->function->code.count - end;
+    if (jump > MAX_JUMP) error(compiler, "Too much code to jump over.");
+    compiler->function->code.data[offset] = (uint8_t) ((jump >> 8) & 0xff);
+    compiler->function->code.data[offset + 1] = (uint8_t) (jump & 0xff);
+}
+
 // Marks the beginning of a loop. Keeps track of the current instruction so we
 // know what to loop back to at the end of the body.
 static void startLoop(Compiler *compiler, Loop *loop) {
@@ -1960,7 +2006,24 @@ static void forStatement(Compiler *compiler) {
     // Evaluate the sequence expression and store it in a hidden local variable.
     // The space in the variable name ensures it won't collide with a user-defined
     // variable.
-    expression(compiler);
+    //
+    // A literal range like `a..b` is not built. Its bounds are kept in two
+    // hidden locals instead and the loop counts over them, see below.
+    parsePrecedence(compiler, (Precedence) (PREC_RANGE + 1));
+    bool isRange = false;
+    bool isInclusive = false;
+    if (match(compiler, RANGE_TOKEN) || match(compiler, SPREAD_OR_REST_TOKEN)) {
+        isRange = true;
+        isInclusive = compiler->parser->previous.type == RANGE_TOKEN;
+        parsePrecedence(compiler, (Precedence) (PREC_RANGE + 1));
+
+        // Something like `a..b == c`, the range is only an operand.
+        if (getRule(compiler->parser->current.type)->precedence >= PREC_LOWEST) {
+            isRange = false;
+            callMethod(compiler, 1, isInclusive ? "..(_)" : "...(_)", isInclusive ? 5 : 6);
+        }
+    }
+    if (!isRange) infixOperators(compiler, PREC_LOWEST, true);
 
     consume(compiler, IN_TOKEN, "Expect 'in' after loop variable.");
     if (withParen) ignoreNewlines(compiler);
@@ -1985,7 +2048,7 @@ static void forStatement(Compiler *compiler) {
     // Note that we expect only two addLocal calls next to each other in the
     // following code.
 
-    if (compiler->numLocals + 3 > MAX_LOCALS) {
+    if (compiler->numLocals + (isRange ? 4 : 3) > MAX_LOCALS) {
         error(compiler,
               "Cannot declare more than %d variables in one scope. (Not enough space for for-loops internal variables)",
               MAX_LOCALS);
@@ -1994,6 +2057,7 @@ static void forStatement(Compiler *compiler) {
 
 
     int seqSlot = addLocal(compiler, "seq ", 4);
+    if (isRange) addLocal(compiler, "to ", 3);
 
     // Create another hidden local for the iterator object.
     null(compiler, false);
@@ -2003,6 +2067,7 @@ static void forStatement(Compiler *compiler) {
     bool up;
     if (peek(compiler) == UP_TOKEN || peek(compiler) == DOWN_TOKEN) {
         up = !match(compiler, DOWN_TOKEN);
+        if (up) match(compiler, UP_TOKEN);
         match(compiler, WITH_TOKEN) ? expression(compiler) : emitConstant(compiler, NUM_VAL(1));
         if (!up) callMethod(compiler, 0, "-", 1);
     } else {
@@ -2013,9 +2078,51 @@ static void forStatement(Compiler *compiler) {
 
     if (withParen) consume(compiler, RPAREN_TOKEN, "Expect ')' after loop expression.");
 
+    // When the bounds of a literal range are numbers, and Diat's range operator
+    // and Funan's iterate(_,_) and iteratorValue(_) are still the built-in
+    // ones, OP_FOR_RANGE_INIT skips over the code that builds the range, and
+    // OP_FOR_RANGE counts from one bound to the other.
+    // Otherwise the range is built by calling the operator, the "to " local is
+    // cleared, and the loop goes through the generic protocol.
+    if (isRange) {
+        emitByteArg(compiler, OP_FOR_RANGE_INIT, seqSlot);
+        emitShort(compiler, isInclusive ? methodSymbol(compiler, "..(_)", 5)
+                                        : methodSymbol(compiler, "...(_)", 6));
+        emitShort(compiler, methodSymbol(compiler, "iterate(_,_)", 12));
+        emitShort(compiler, methodSymbol(compiler, "iteratorValue(_)", 16));
+        int skipRange = emitByte(compiler, 0xff);
+        emitByte(compiler, 0xff);
+        loadLocal(compiler, seqSlot);
+        loadLocal(compiler, seqSlot + 1);
+        callMethod(compiler, 1, isInclusive ? "..(_)" : "...(_)", isInclusive ? 5 : 6);
+        emitByteArg(compiler, OP_STORE_LOCAL, seqSlot);
+        emitOp(compiler, OP_POP);
+        emitOp(compiler, OP_FALSE);
+        emitByteArg(compiler, OP_STORE_LOCAL, seqSlot + 1);
+        emitOp(compiler, OP_POP);
+        patchForIter(compiler, skipRange, skipRange + 2);
+    }
+
     Loop loop;
     startLoop(compiler, &loop);
 
+    // Built-in sequences are stepped by OP_FOR_ITER, which jumps either to the
+    // exit test or straight to the body. Other sequences fall through to the
+    // generic protocol. It relies on the hidden locals being adjacent. Literal
+    // ranges are stepped the same way by OP_FOR_RANGE.
+    if (isRange) {
+        emitByteArg(compiler, OP_FOR_RANGE, seqSlot);
+        emitByte(compiler, isInclusive);
+    } else {
+        emitByteArg(compiler, OP_FOR_ITER, seqSlot);
+        emitShort(compiler, methodSymbol(compiler, "iterate(_,_)", 12));
+        emitShort(compiler, methodSymbol(compiler, "iteratorValue(_)", 16));
+    }
+    int forIterTest = emitByte(compiler, 0xff);
+    emitByte(compiler, 0xff);
+    int forIterBody = emitByte(compiler, 0xff);
+    emitByte(compiler, 0xff);
+
     // Advance the iterator by calling the ".iterate" method on the sequence.
     loadLocal(compiler, seqSlot);
     loadLocal(compiler, iterSlot);
@@ -2023,12 +2130,14 @@ static void forStatement(Compiler *compiler) {
     // Update and test the iterator.
     callMethod(compiler, 2, "iterate(_,_)", 12);
     emitByteArg(compiler, OP_STORE_LOCAL, iterSlot);
+    patchForIter(compiler, forIterTest, forIterBody + 2);
     testExitLoop(compiler);
 
     // Get the current value in the sequence by calling ".iteratorValue".
     loadLocal(compiler, seqSlot);
     loadLocal(compiler, iterSlot);
     callMethod(compiler, 1, "iteratorValue(_)", 16);
+    patchForIter(compiler, forIterBody, forIterBody + 2);
 
     // Bind the loop variable in its own scope. This ensures we get a fresh
     // variable each iteration so that closures for it don't all see the same one.
@@ -2100,6 +2209,54 @@ static void whileStatement(Compiler *compiler) {
     endLoop(compiler);
 }
 
+// Compiles an `ake { ... } namason (e) { ... }` statement.
+//
+// The guarded block runs as plain code: the only trace of it is an entry in
+// the function's handler table, which runtimeError() looks up when an error
+// is raised. The error variable is optional.
+static void tryStatement(Compiler *compiler) {
+    // `ake` is a statement, so only the locals are on the stack here. numSlots
+    // is only an estimate, which calls with an argument count leave too high.
+    Handler handler;
+    handler.depth = compiler->numLocals;
+
+    consume(compiler, LBRACE_TOKEN, "Expect '{' after 'ake'.");
+    handler.start = compiler->function->code.count;
+    pushScope(compiler);
+    if (finishBlock(compiler, false)) emitOp(compiler, OP_POP);
+    popScope(compiler);
+    handler.end = compiler->function->code.count;
+
+    // Skip the handler when the block finishes normally.
+    int skipJump = emitJump(compiler, OP_JUMP);
+    handler.target = compiler->function->code.count;
+    MSCWriteHandlerBuffer(compiler->parser->vm, &compiler->function->handlers, handler);
+
+    consume(compiler, CATCH_TOKEN, "Expect 'namason' after 'ake' block.");
+
+    // The error is pushed by the VM before jumping to the handler.
+    pushScope(compiler);
+    compiler->numSlots = handler.depth + 1;
+    if (compiler->numSlots > compiler->function->maxSlots) {
+        compiler->function->maxSlots = compiler->numSlots;
+    }
+    if (match(compiler, LPAREN_TOKEN)) {
+        consume(compiler, ID_TOKEN, "Expect error variable name.");
+        declareVariable(compiler, NULL);
+        consume(compiler, RPAREN_TOKEN, "Expect ')' after error variable.");
+    } else {
+        addLocal(compiler, "error ", 6);
+    }
+
+    consume(compiler, LBRACE_TOKEN, "Expect '{' after 'namason'.");
+    pushScope(compiler);
+    if (finishBlock(compiler, false)) emitOp(compiler, OP_POP);
+    popScope(compiler);
+    popScope(compiler);
+
+    patchJump(compiler, skipJump);
+}
+
 
 static bool statement(Compiler *compiler, bool expr) {
     if (match(compiler, BREAK_TOKEN)) {
@@ -2141,11 +2298,12 @@ static bool statement(Compiler *compiler, bool expr) {
         TokenType tokenType = peek(compiler);
         if (tokenType == EOL_TOKEN || tokenType == SEMI_TOKEN) {
             // If there's no expression after return, initializers should
-            // return 'this' and regular methods should return null
-            // If there's no expression after return, initializers should
-            // return 'this' and regular methods should return null
-            Opcode result = compiler->isInitializer ? OP_LOAD_LOCAL_0 : OP_NULL;
-            emitOp(compiler, result);
+            // return 'this', regular methods should return null and
+            // generators just end.
+            if (!compiler->isGenerator) {
+                Opcode result = compiler->isInitializer ? OP_LOAD_LOCAL_0 : OP_NULL;
+                emitOp(compiler, result);
+            }
         } else {
             if (!match(compiler, WITH_TOKEN)) {
                 error(compiler, "Expected 'niin' keyword after 'segin'");
@@ -2153,11 +2311,16 @@ static bool statement(Compiler *compiler, bool expr) {
             if (compiler->isInitializer) {
                 error(compiler, "A constructor cannot return a value.");
             }
+            if (compiler->isGenerator) {
+                error(compiler, "A 'tii*' function cannot return a value.");
+            }
             expression(compiler);
         }
-        emitOp(compiler, OP_RETURN);
+        emitOp(compiler, compiler->isGenerator ? OP_GENERATOR_END : OP_RETURN);
     } else if (match(compiler, WHILE_TILL_TOKEN)) {
         whileStatement(compiler);
+    } else if (match(compiler, DO_TOKEN)) {
+        tryStatement(compiler);
     } else if (match(compiler, LBRACE_TOKEN)) {
         // Block statement.
         int tmpSlot = -1;
@@ -2865,41 +3028,63 @@ static void literal(Compiler *compiler, bool canAssign) {
     emitConstant(compiler, compiler->parser->previous.value);
 }
 
+// Emits OP_INTERPOLATE, which pops [numParts] strings and pushes the string
+// joining them. Its stack effect depends on its argument, so it is tracked
+// here.
+static void emitInterpolate(Compiler *compiler, int numParts) {
+    emitByteArg(compiler, OP_INTERPOLATE, numParts);
+    compiler->numSlots -= numParts - 1;
+}
+
+// Counts a part of a string interpolation pushed on the stack. OP_INTERPOLATE
+// takes at most 255 parts, so longer strings are joined in chunks.
+static void interpolationPart(Compiler *compiler, int *numParts) {
+    if (++*numParts == UINT8_MAX) {
+        emitInterpolate(compiler, UINT8_MAX);
+        *numParts = 1;
+    }
+}
+
+// Pushes the string literal part of an interpolation, unless it is empty.
+static void interpolationLiteral(Compiler *compiler, int *numParts) {
+    Value value = compiler->parser->previous.value;
+    if (IS_STRING(value) && AS_STRING(value)->length == 0) return;
+    literal(compiler, false);
+    interpolationPart(compiler, numParts);
+}
+
 // A string literal that contains interpolated expressions.
 //
-// Interpolation is syntactic sugar for calling ".join()" on a list. So the
-// string:
+// The parts are pushed on the stack, with the interpolated values converted
+// by their "sebenma" method, and OP_INTERPOLATE joins them into one string. So
+// the string:
 //
-//     "a %(b + c) d"
+//     "a ${b + c} d"
 //
 // is compiled roughly like:
 //
-//     ["a ", b + c, " d"].kunben()
+//     "a " (b + c).sebenma " d" INTERPOLATE 3
 static void stringInterpolation(Compiler *compiler, bool canAssign) {
-    // Instantiate a new list.
-    loadCoreVariable(compiler, "Walan");
-    callMethod(compiler, 0, "kura()", 6);
+    int numParts = 0;
 
     do {
         // The opening string part.
-        literal(compiler, false);
-        callMethod(compiler, 1, "aFaraAkan_(_)", 13);
+        interpolationLiteral(compiler, &numParts);
 
         // The interpolated expression.
         ignoreNewlines(compiler);
         expression(compiler);
-        callMethod(compiler, 1, "aFaraAkan_(_)", 13);
+        emitShortArg(compiler, OP_TO_STRING, methodSymbol(compiler, "sebenma", 7));
+        interpolationPart(compiler, &numParts);
 
         ignoreNewlines(compiler);
     } while (match(compiler, DOLLAR_INTERPOL_TOKEN));
 
     // The trailing string part.
     consume(compiler, STRING_CONST_TOKEN, "Expect end of string interpolation.");
-    literal(compiler, false);
-    callMethod(compiler, 1, "aFaraAkan_(_)", 13);
+    interpolationLiteral(compiler, &numParts);
 
-    // The list of interpolated parts.
-    callMethod(compiler, 0, "kunBen()", 8);
+    emitInterpolate(compiler, numParts);
 }
 
 static void super_(Compiler *compiler, bool canAssign) {
@@ -3394,6 +3579,7 @@ GrammarRule rules[] = {
         /* NULLISH_TOKEN                 81 */ INFIX(PREC_NULLISH, conditional),
         /* NULLCHECK_TOKEN               82 */ INFIX(PREC_CALL, call),
         /* AT_TOKEN                      83 */ UNUSED,
+        /* YIELD_TOKEN                   84 */ PREFIX(yieldExpression),
 
 };
 
@@ -3420,7 +3606,12 @@ static void parsePrecedence(Compiler *compiler, Precedence precedence) {
     // "=". If so, it will parse the "=" itself and handle it appropriately.
     bool canAssign = precedence <= PREC_NULLISH;
     prefix(compiler, canAssign);
+    infixOperators(compiler, precedence, canAssign);
+}
 
+// Compiles the infix operators that follow an already compiled operand, as
+// long as they bind at least as tightly as [precedence].
+static void infixOperators(Compiler *compiler, Precedence precedence, bool canAssign) {
     while (precedence <= rules[compiler->parser->current.type].precedence) {
 
         nextToken(compiler->parser);
@@ -3895,6 +4086,16 @@ static void whenExpression(Compiler *compiler, bool canAssign) {
 
 }
 
+// Compiles `labo value`, which produces [value] from a `tii*` function and
+// evaluates to null when the function is resumed.
+static void yieldExpression(Compiler *compiler, bool canAssign) {
+    if (!compiler->isGenerator) {
+        error(compiler, "Cannot use 'labo' outside of a 'tii*' function.");
+    }
+    expression(compiler);
+    emitOp(compiler, OP_YIELD);
+}
+
 static void ifExpression(Compiler *compiler, bool canAssign) {
     ifStatement(compiler, true);
 }
@@ -3970,7 +4171,7 @@ static void emitAttributes(Compiler *compiler, Map *attributes) {
 
     // The attributes are stored as group = { key:[value, value, ...] }
     // so our first level is the group map
-    for (uint32_t groupIdx = 0; groupIdx < attributes->capacity; groupIdx++) {
+    for (uint32_t groupIdx = 0; groupIdx < attributes->used; groupIdx++) {
         const MapEntry *groupEntry = &attributes->entries[groupIdx];
         if (IS_UNDEFINED(groupEntry->key)) continue;
         //group key
@@ -3981,7 +4182,7 @@ static void emitAttributes(Compiler *compiler, Map *attributes) {
         callMethod(compiler, 0, "kura()", 6);
 
         Map *groupItems = AS_MAP(groupEntry->value);
-        for (uint32_t itemIdx = 0; itemIdx < groupItems->capacity; itemIdx++) {
+        for (uint32_t itemIdx = 0; itemIdx < groupItems->used; itemIdx++) {
             const MapEntry *itemEntry = &groupItems->entries[itemIdx];
             if (IS_UNDEFINED(itemEntry->key)) continue;
 
@@ -4012,7 +4213,7 @@ static void emitAttributeMethods(Compiler *compiler, Map *attributes) {
     loadCoreVariable(compiler, "Wala");
     callMethod(compiler, 0, "kura()", 6);
 
-    for (uint32_t methodIdx = 0; methodIdx < attributes->capacity; methodIdx++) {
+    for (uint32_t methodIdx = 0; methodIdx < attributes->used; methodIdx++) {
         const MapEntry *methodEntry = &attributes->entries[methodIdx];
         if (IS_UNDEFINED(methodEntry->key)) continue;
         emitConstant(compiler, methodEntry->key);
@@ -4050,7 +4251,7 @@ static void copyAttributes(Compiler *compiler, Map *into) {
 
     // Note we copy the actual values as is since we'll take ownership
     // and clear the original map
-    for (uint32_t attrIdx = 0; attrIdx < compiler->attributes->capacity; attrIdx++) {
+    for (uint32_t attrIdx = 0; attrIdx < compiler->attributes->used; attrIdx++) {
         const MapEntry *attrEntry = &compiler->attributes->entries[attrIdx];
         if (IS_UNDEFINED(attrEntry->key)) continue;
         MSCMapSet(into, vm, attrEntry->key, attrEntry->value);
@@ -4,7 +4,9 @@
 
 #include "Parser.h"
 #include "../runtime/MVM.h"
+#include "../helpers/Number.h"
 #include <errno.h>
+#include <math.h>
 
 static Keyword keywords[] =
         {
@@ -41,6 +43,7 @@ static Keyword keywords[] =
                 {"ipan",    4, CONTINUE_TOKEN},
                 {"afili",   5, THROW_TOKEN},
                 {"dunan",   5, EXTERN_TOKEN},
+                {"labo",    4, YIELD_TOKEN},
                 {NULL,      0, EOF_TOKEN} // Sentinel to mark the end of the array.
 
         };
@@ -230,7 +233,12 @@ static void makeNumber(Parser *parser, int base) {
     if (base != 10) {
         parser->next.value = NUM_VAL((double) strtoll(parser->tokenStart, NULL, base));
     } else {
-        parser->next.value = NUM_VAL(strtod(parser->tokenStart, NULL));
+        double value;
+        MSCDoubleFromChars(parser->tokenStart,
+                           (size_t) (parser->currentChar - parser->tokenStart), &value);
+        // Only overflowing is an error, tiny numbers just lose precision.
+        errno = isinf(value) ? ERANGE : 0;
+        parser->next.value = NUM_VAL(value);
     }
 
     if (errno == ERANGE) {
@@ -238,7 +246,7 @@ static void makeNumber(Parser *parser, int base) {
         parser->next.value = NUM_VAL(0);
     }
     // We don't check that the entire token is consumed after calling strtoll()
-    // or strtod() because we've already scanned it ourselves and know it's valid.
+    // or MSCDoubleFromChars() because we've already scanned it ourselves and know it's valid.
     makeToken(parser, NUMBER_CONST_TOKEN);
 }
 
@@ -93,6 +93,7 @@ typedef enum {
     NULLISH_TOKEN = 81,
     NULLCHECK_TOKEN = 82,
     AT_TOKEN = 83,
+    YIELD_TOKEN = 84,
 } TokenType;
 
 typedef struct {
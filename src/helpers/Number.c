@@ -0,0 +1,438 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#include "Number.h"
+#include <locale.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// Formatting follows Florian Loitsch's "Printing Floating-Point Numbers Quickly
+// and Accurately with Integers" (Grisu2), laid out like Milo Yip's version. It
+// always reads back as the same double and is the shortest such decimal for
+// all but a very few values, where it is one digit longer.
+
+// A floating point number [f] * 2^[e] with a 64 bits significand.
+typedef struct {
+    uint64_t f;
+    int e;
+} DiyFp;
+
+#define DP_SIGNIFICAND_SIZE 52
+#define DP_EXPONENT_BIAS (0x3FF + DP_SIGNIFICAND_SIZE)
+#define DP_MIN_EXPONENT (-DP_EXPONENT_BIAS)
+#define DP_SIGNIFICAND_MASK UINT64_C(0x000FFFFFFFFFFFFF)
+#define DP_HIDDEN_BIT UINT64_C(0x0010000000000000)
+
+// The normalized significands and binary exponents of 10^k for k = -348,
+// -340, ..., 340.
+static const uint64_t cachedPowersF[] = {
+    UINT64_C(0xfa8fd5a0081c0288), UINT64_C(0xbaaee17fa23ebf76), UINT64_C(0x8b16fb203055ac76),
+    UINT64_C(0xcf42894a5dce35ea), UINT64_C(0x9a6bb0aa55653b2d), UINT64_C(0xe61acf033d1a45df),
+    UINT64_C(0xab70fe17c79ac6ca), UINT64_C(0xff77b1fcbebcdc4f), UINT64_C(0xbe5691ef416bd60c),
+    UINT64_C(0x8dd01fad907ffc3c), UINT64_C(0xd3515c2831559a83), UINT64_C(0x9d71ac8fada6c9b5),
+    UINT64_C(0xea9c227723ee8bcb), UINT64_C(0xaecc49914078536d), UINT64_C(0x823c12795db6ce57),
+    UINT64_C(0xc21094364dfb5637), UINT64_C(0x9096ea6f3848984f), UINT64_C(0xd77485cb25823ac7),
+    UINT64_C(0xa086cfcd97bf97f4), UINT64_C(0xef340a98172aace5), UINT64_C(0xb23867fb2a35b28e),
+    UINT64_C(0x84c8d4dfd2c63f3b), UINT64_C(0xc5dd44271ad3cdba), UINT64_C(0x936b9fcebb25c996),
+    UINT64_C(0xdbac6c247d62a584), UINT64_C(0xa3ab66580d5fdaf6), UINT64_C(0xf3e2f893dec3f126),
+    UINT64_C(0xb5b5ada8aaff80b8), UINT64_C(0x87625f056c7c4a8b), UINT64_C(0xc9bcff6034c13053),
+    UINT64_C(0x964e858c91ba2655), UINT64_C(0xdff9772470297ebd), UINT64_C(0xa6dfbd9fb8e5b88f),
+    UINT64_C(0xf8a95fcf88747d94), UINT64_C(0xb94470938fa89bcf), UINT64_C(0x8a08f0f8bf0f156b),
+    UINT64_C(0xcdb02555653131b6), UINT64_C(0x993fe2c6d07b7fac), UINT64_C(0xe45c10c42a2b3b06),
+    UINT64_C(0xaa242499697392d3), UINT64_C(0xfd87b5f28300ca0e), UINT64_C(0xbce5086492111aeb),
+    UINT64_C(0x8cbccc096f5088cc), UINT64_C(0xd1b71758e219652c), UINT64_C(0x9c40000000000000),
+    UINT64_C(0xe8d4a51000000000), UINT64_C(0xad78ebc5ac620000), UINT64_C(0x813f3978f8940984),
+    UINT64_C(0xc097ce7bc90715b3), UINT64_C(0x8f7e32ce7bea5c70), UINT64_C(0xd5d238a4abe98068),
+    UINT64_C(0x9f4f2726179a2245), UINT64_C(0xed63a231d4c4fb27), UINT64_C(0xb0de65388cc8ada8),
+    UINT64_C(0x83c7088e1aab65db), UINT64_C(0xc45d1df942711d9a), UINT64_C(0x924d692ca61be758),
+    UINT64_C(0xda01ee641a708dea), UINT64_C(0xa26da3999aef774a), UINT64_C(0xf209787bb47d6b85),
+    UINT64_C(0xb454e4a179dd1877), UINT64_C(0x865b86925b9bc5c2), UINT64_C(0xc83553c5c8965d3d),
+    UINT64_C(0x952ab45cfa97a0b3), UINT64_C(0xde469fbd99a05fe3), UINT64_C(0xa59bc234db398c25),
+    UINT64_C(0xf6c69a72a3989f5c), UINT64_C(0xb7dcbf5354e9bece), UINT64_C(0x88fcf317f22241e2),
+    UINT64_C(0xcc20ce9bd35c78a5), UINT64_C(0x98165af37b2153df), UINT64_C(0xe2a0b5dc971f303a),
+    UINT64_C(0xa8d9d1535ce3b396), UINT64_C(0xfb9b7cd9a4a7443c), UINT64_C(0xbb764c4ca7a44410),
+    UINT64_C(0x8bab8eefb6409c1a), UINT64_C(0xd01fef10a657842c), UINT64_C(0x9b10a4e5e9913129),
+    UINT64_C(0xe7109bfba19c0c9d), UINT64_C(0xac2820d9623bf429), UINT64_C(0x80444b5e7aa7cf85),
+    UINT64_C(0xbf21e44003acdd2d), UINT64_C(0x8e679c2f5e44ff8f), UINT64_C(0xd433179d9c8cb841),
+    UINT64_C(0x9e19db92b4e31ba9), UINT64_C(0xeb96bf6ebadf77d9), UINT64_C(0xaf87023b9bf0ee6b),
+};
+
+static const short cachedPowersE[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t pow10s[] = {
+    UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000),
+    UINT64_C(100000), UINT64_C(1000000), UINT64_C(10000000),
+    UINT64_C(100000000), UINT64_C(1000000000), UINT64_C(10000000000),
+    UINT64_C(100000000000), UINT64_C(1000000000000),
+    UINT64_C(10000000000000), UINT64_C(100000000000000),
+    UINT64_C(1000000000000000), UINT64_C(10000000000000000),
+    UINT64_C(100000000000000000), UINT64_C(1000000000000000000),
+    UINT64_C(10000000000000000000)
+};
+
+static DiyFp diyFpFromDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biasedExponent = (int) (bits >> DP_SIGNIFICAND_SIZE);
+    uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+    DiyFp result;
+    if (biasedExponent != 0) {
+        result.f = significand + DP_HIDDEN_BIT;
+        result.e = biasedExponent - DP_EXPONENT_BIAS;
+    } else {
+        // Subnormal.
+        result.f = significand;
+        result.e = DP_MIN_EXPONENT + 1;
+    }
+    return result;
+}
+
+static DiyFp diyFpMultiply(DiyFp x, DiyFp y) {
+    const uint64_t mask32 = UINT64_C(0xFFFFFFFF);
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & mask32;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & mask32;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & mask32) + (bc & mask32);
+    // Round the lower half.
+    tmp += UINT64_C(1) << 31;
+    DiyFp result;
+    result.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+    result.e = x.e + y.e + 64;
+    return result;
+}
+
+static DiyFp diyFpNormalize(DiyFp value) {
+    while (!(value.f & (UINT64_C(1) << 63))) {
+        value.f <<= 1;
+        value.e--;
+    }
+    return value;
+}
+
+// Computes the boundaries [minus] and [plus] halfway to the neighbours of
+// [value], both with the exponent of the normalized [plus].
+static void normalizedBoundaries(DiyFp value, DiyFp *minus, DiyFp *plus) {
+    DiyFp high = {(value.f << 1) + 1, value.e - 1};
+    while (!(high.f & (DP_HIDDEN_BIT << 1))) {
+        high.f <<= 1;
+        high.e--;
+    }
+    high.f <<= 64 - DP_SIGNIFICAND_SIZE - 2;
+    high.e -= 64 - DP_SIGNIFICAND_SIZE - 2;
+
+    // The neighbour below a power of two is twice as close.
+    DiyFp low;
+    if (value.f == DP_HIDDEN_BIT) {
+        low.f = (value.f << 2) - 1;
+        low.e = value.e - 2;
+    } else {
+        low.f = (value.f << 1) - 1;
+        low.e = value.e - 1;
+    }
+    low.f <<= low.e - high.e;
+    low.e = high.e;
+
+    *minus = low;
+    *plus = high;
+}
+
+// Returns a cached 10^-K such that multiplying a number with binary exponent
+// [e] by it brings the exponent in [-60, -32].
+static DiyFp cachedPower(int e, int *K) {
+    // 0.30102999566398114 is log10(2).
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int) dk;
+    if (dk - k > 0.0) k++;
+
+    unsigned index = (unsigned) ((k >> 3) + 1);
+    *K = -(-348 + (int) (index << 3));
+    DiyFp result = {cachedPowersF[index], cachedPowersE[index]};
+    return result;
+}
+
+// Nudges the last digit down while that brings the digits closer to the
+// real value and keeps them inside the rounding interval.
+static void grisuRound(char *buffer, int length, uint64_t delta, uint64_t rest,
+                       uint64_t tenKappa, uint64_t distance) {
+    while (rest < distance && delta - rest >= tenKappa &&
+           (rest + tenKappa < distance ||
+            distance - rest > rest + tenKappa - distance)) {
+        buffer[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+static int countDecimalDigits(uint32_t n) {
+    int count = 1;
+    while (count < 10 && n >= pow10s[count]) count++;
+    return count;
+}
+
+// Generates the shortest digits of [W] that stay within [delta] below [Mp].
+static void digitGen(DiyFp W, DiyFp Mp, uint64_t delta, char *buffer,
+                     int *length, int *K) {
+    DiyFp one = {UINT64_C(1) << -Mp.e, Mp.e};
+    uint64_t distance = Mp.f - W.f;
+    uint32_t p1 = (uint32_t) (Mp.f >> -one.e);
+    uint64_t p2 = Mp.f & (one.f - 1);
+    int kappa = countDecimalDigits(p1);
+    *length = 0;
+
+    // The integral part.
+    while (kappa > 0) {
+        uint32_t divisor = (uint32_t) pow10s[kappa - 1];
+        uint32_t digit = p1 / divisor;
+        p1 %= divisor;
+        if (digit || *length) buffer[(*length)++] = (char) ('0' + digit);
+        kappa--;
+        uint64_t rest = ((uint64_t) p1 << -one.e) + p2;
+        if (rest <= delta) {
+            *K += kappa;
+            grisuRound(buffer, *length, delta, rest, pow10s[kappa] << -one.e,
+                       distance);
+            return;
+        }
+    }
+
+    // The fractional part.
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char digit = (char) (p2 >> -one.e);
+        if (digit || *length) buffer[(*length)++] = (char) ('0' + digit);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            *K += kappa;
+            int index = -kappa;
+            grisuRound(buffer, *length, delta, p2, one.f,
+                       distance * (index < 20 ? pow10s[index] : 0));
+            return;
+        }
+    }
+}
+
+// Writes the digits of the positive, finite [value] into [buffer] and sets
+// [K] so that [value] is about digits * 10^K.
+static void grisu2(double value, char *buffer, int *length, int *K) {
+    DiyFp v = diyFpFromDouble(value);
+    DiyFp minus, plus;
+    normalizedBoundaries(v, &minus, &plus);
+
+    DiyFp cached = cachedPower(plus.e, K);
+    DiyFp W = diyFpMultiply(diyFpNormalize(v), cached);
+    DiyFp Wp = diyFpMultiply(plus, cached);
+    DiyFp Wm = diyFpMultiply(minus, cached);
+    // Stay on the safe side of the imprecise boundaries.
+    Wm.f++;
+    Wp.f--;
+    digitGen(W, Wp, Wp.f - Wm.f, buffer, length, K);
+}
+
+int MSCDoubleToChars(double value, char *buffer) {
+    char *start = buffer;
+    if (signbit(value)) {
+        *buffer++ = '-';
+        value = -value;
+    }
+    if (value == 0.0) {
+        *buffer++ = '0';
+        *buffer = '\0';
+        return (int) (buffer - start);
+    }
+
+    char digits[20];
+    int length, K;
+    grisu2(value, digits, &length, &K);
+
+    // The position of the decimal point relative to the first digit.
+    int point = length + K;
+
+    if (length <= point && point <= 21) {
+        // An integer: 1234e7 -> 12340000000.
+        memcpy(buffer, digits, (size_t) length);
+        memset(buffer + length, '0', (size_t) (point - length));
+        buffer += point;
+    } else if (0 < point && point <= 21) {
+        // 1234e-2 -> 12.34.
+        memcpy(buffer, digits, (size_t) point);
+        buffer[point] = '.';
+        memcpy(buffer + point + 1, digits + point, (size_t) (length - point));
+        buffer += length + 1;
+    } else if (-6 < point && point <= 0) {
+        // 1234e-6 -> 0.001234.
+        buffer[0] = '0';
+        buffer[1] = '.';
+        memset(buffer + 2, '0', (size_t) -point);
+        memcpy(buffer + 2 - point, digits, (size_t) length);
+        buffer += 2 - point + length;
+    } else {
+        // 1234e30 -> 1.234e+33.
+        *buffer++ = digits[0];
+        if (length > 1) {
+            *buffer++ = '.';
+            memcpy(buffer, digits + 1, (size_t) (length - 1));
+            buffer += length - 1;
+        }
+        *buffer++ = 'e';
+        int exponent = point - 1;
+        if (exponent < 0) {
+            *buffer++ = '-';
+            exponent = -exponent;
+        } else {
+            *buffer++ = '+';
+        }
+        if (exponent >= 100) *buffer++ = (char) ('0' + exponent / 100);
+        if (exponent >= 10) *buffer++ = (char) ('0' + exponent / 10 % 10);
+        *buffer++ = (char) ('0' + exponent % 10);
+    }
+
+    *buffer = '\0';
+    return (int) (buffer - start);
+}
+
+// The powers of ten that are exact doubles.
+static const double exactPow10s[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+    1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define MAX_EXACT_INTEGER (UINT64_C(1) << 53)
+
+// Hands the [length] chars at [chars], which hold a number in the syntax
+// MSCDoubleFromChars() accepts, to strtod() with the decimal point of the
+// current locale.
+static double slowDoubleFromChars(const char *chars, size_t length) {
+    const char *point = localeconv()->decimal_point;
+    if (point == NULL || point[0] == '\0') point = ".";
+    size_t pointLength = strlen(point);
+
+    char small[64];
+    size_t size = length + pointLength + 1;
+    char *copy = size <= sizeof(small) ? small : (char *) malloc(size);
+    if (copy == NULL) return strtod(chars, NULL);
+
+    size_t to = 0;
+    for (size_t from = 0; from < length; from++) {
+        if (chars[from] == '.') {
+            memcpy(copy + to, point, pointLength);
+            to += pointLength;
+        } else {
+            copy[to++] = chars[from];
+        }
+    }
+    copy[to] = '\0';
+
+    double value = strtod(copy, NULL);
+    if (copy != small) free(copy);
+    return value;
+}
+
+size_t MSCDoubleFromChars(const char *chars, size_t length, double *value) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < length && (chars[i] == '-' || chars[i] == '+')) {
+        negative = chars[i] == '-';
+        i++;
+    }
+
+    // Keep the first 19 significant digits, which always fit in 64 bits, and
+    // count the others as powers of ten.
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool truncated = false;
+    size_t digitCount = 0;
+
+    for (; i < length && chars[i] >= '0' && chars[i] <= '9'; i++, digitCount++) {
+        int digit = chars[i] - '0';
+        if (significant < 19) {
+            mantissa = mantissa * 10 + (uint64_t) digit;
+            if (mantissa != 0) significant++;
+        } else {
+            exponent++;
+            if (digit != 0) truncated = true;
+        }
+    }
+
+    if (i < length && chars[i] == '.' && i + 1 < length &&
+        chars[i + 1] >= '0' && chars[i + 1] <= '9') {
+        for (i++; i < length && chars[i] >= '0' && chars[i] <= '9'; i++, digitCount++) {
+            int digit = chars[i] - '0';
+            if (significant < 19) {
+                mantissa = mantissa * 10 + (uint64_t) digit;
+                if (mantissa != 0) significant++;
+                exponent--;
+            } else if (digit != 0) {
+                truncated = true;
+            }
+        }
+    }
+
+    if (digitCount == 0) return 0;
+
+    if (i < length && (chars[i] == 'e' || chars[i] == 'E')) {
+        size_t j = i + 1;
+        bool negativeExponent = false;
+        if (j < length && (chars[j] == '-' || chars[j] == '+')) {
+            negativeExponent = chars[j] == '-';
+            j++;
+        }
+        if (j < length && chars[j] >= '0' && chars[j] <= '9') {
+            int explicitExponent = 0;
+            for (; j < length && chars[j] >= '0' && chars[j] <= '9'; j++) {
+                // Anything past this is zero or an infinity anyway.
+                if (explicitExponent < 100000) {
+                    explicitExponent = explicitExponent * 10 + (chars[j] - '0');
+                }
+            }
+            exponent += negativeExponent ? -explicitExponent : explicitExponent;
+            i = j;
+        }
+    }
+
+    double result;
+    if (mantissa == 0) {
+        result = 0.0;
+    } else if (!truncated && mantissa <= MAX_EXACT_INTEGER &&
+               exponent >= -22 && exponent <= 22) {
+        // Both the mantissa and the power of ten are exact doubles, so a
+        // single multiplication or division rounds correctly.
+        result = (double) mantissa;
+        if (exponent > 0) {
+            result *= exactPow10s[exponent];
+        } else if (exponent < 0) {
+            result /= exactPow10s[-exponent];
+        }
+    } else if (!truncated && exponent > 22 && exponent <= 22 + 15 &&
+               mantissa <= MAX_EXACT_INTEGER / pow10s[exponent - 22]) {
+        // Move the extra powers of ten into the mantissa while it stays exact,
+        // as in 12e30 -> 12000000000e22.
+        result = (double) (mantissa * pow10s[exponent - 22]) * 1e22;
+    } else {
+        *value = slowDoubleFromChars(chars, i);
+        return i;
+    }
+
+    *value = negative ? -result : result;
+    return i;
+}
@@ -0,0 +1,28 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#ifndef CPMSC_NUMBER_H
+#define CPMSC_NUMBER_H
+
+#include <stddef.h>
+
+// Writes the shortest decimal form of the finite [value] that reads back as
+// the same double into [buffer], followed by a "\0", and returns the number of
+// chars written.
+//
+// The digits come from Grisu2. Like JavaScript, the number is written in
+// plain notation when its decimal exponent is in [-7, 21) and in scientific
+// notation ("1.5e+21", "5e-324") otherwise. [buffer] must hold at least 26
+// chars.
+int MSCDoubleToChars(double value, char *buffer);
+
+// Parses the decimal number at the start of [chars], an optional "-" or "+",
+// digits with an optional fraction and an optional exponent, into [value] and
+// returns the number of chars read, or 0 if there is no number there.
+//
+// The result is correctly rounded and does not depend on the C locale. A
+// number too large for a double reads as an infinity.
+size_t MSCDoubleFromChars(const char *chars, size_t length, double *value);
+
+#endif //CPMSC_NUMBER_H
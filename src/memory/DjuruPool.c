@@ -0,0 +1,116 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#include "DjuruPool.h"
+#include "GC.h"
+#include "../runtime/MVM.h"
+
+static int bucketOf(int capacity) {
+    int bucket = 0;
+    while ((1 << bucket) < capacity) bucket++;
+    return bucket;
+}
+
+// Pops a block of [size] bytes off [list], or allocates one if it is empty.
+// A reused block still counts as allocated, so the collector keeps its pace.
+static void *take(MVM *vm, void **list, size_t size) {
+    void *block = *list;
+    if (block == NULL) return MSCReallocate(vm->gc, NULL, 0, size);
+
+    *list = *(void **) block;
+    vm->djuruPool.bytes -= size;
+    vm->gc->bytesAllocated += size;
+    return block;
+}
+
+// Pushes [block] of [size] bytes on [list], or frees it if the pool is full.
+static void give(MVM *vm, void **list, void *block, size_t size) {
+    DjuruPool *pool = &vm->djuruPool;
+    if (pool->bytes + size > DJURU_POOL_BYTES) {
+        DEALLOCATE(vm, block);
+        return;
+    }
+
+    *(void **) block = *list;
+    *list = block;
+    pool->bytes += size;
+}
+
+static void freeList(MVM *vm, void **list) {
+    while (*list != NULL) {
+        void *block = *list;
+        *list = *(void **) block;
+        DEALLOCATE(vm, block);
+    }
+}
+
+SmallDjuru *MSCTakeSmallDjuru(MVM *vm) {
+    DjuruPool *pool = &vm->djuruPool;
+    return (SmallDjuru *) take(vm, &pool->smallDjurus, sizeof(SmallDjuru));
+}
+
+Value *MSCTakeStack(MVM *vm, int capacity) {
+    int bucket = bucketOf(capacity);
+    if (bucket >= DJURU_POOL_BUCKETS) return ALLOCATE_ARRAY(vm, Value, capacity);
+
+    DjuruPool *pool = &vm->djuruPool;
+    return (Value *) take(vm, &pool->stacks[bucket], sizeof(Value) * capacity);
+}
+
+CallFrame *MSCTakeFrames(MVM *vm, int capacity) {
+    int bucket = bucketOf(capacity);
+    if (bucket >= DJURU_POOL_BUCKETS) return ALLOCATE_ARRAY(vm, CallFrame, capacity);
+
+    DjuruPool *pool = &vm->djuruPool;
+    return (CallFrame *) take(vm, &pool->frames[bucket], sizeof(CallFrame) * capacity);
+}
+
+void MSCGiveStack(MVM *vm, Value *stack, int capacity) {
+    int bucket = bucketOf(capacity);
+    if (bucket >= DJURU_POOL_BUCKETS) {
+        DEALLOCATE(vm, stack);
+        return;
+    }
+
+    DjuruPool *pool = &vm->djuruPool;
+    give(vm, &pool->stacks[bucket], stack, sizeof(Value) * capacity);
+}
+
+void MSCGiveFrames(MVM *vm, CallFrame *frames, int capacity) {
+    int bucket = bucketOf(capacity);
+    if (bucket >= DJURU_POOL_BUCKETS) {
+        DEALLOCATE(vm, frames);
+        return;
+    }
+
+    DjuruPool *pool = &vm->djuruPool;
+    give(vm, &pool->frames[bucket], frames, sizeof(CallFrame) * capacity);
+}
+
+void MSCGiveDjuru(MVM *vm, Djuru *djuru) {
+    if (!djuru->small) {
+        MSCGiveFrames(vm, djuru->frames, djuru->frameCapacity);
+        MSCGiveStack(vm, djuru->stack, djuru->stackCapacity);
+        DEALLOCATE(vm, djuru);
+        return;
+    }
+
+    // The arrays may have outgrown the djuru.
+    SmallDjuru *small = (SmallDjuru *) djuru;
+    if (djuru->frames != small->frames) MSCGiveFrames(vm, djuru->frames, djuru->frameCapacity);
+    if (djuru->stack != small->stack) MSCGiveStack(vm, djuru->stack, djuru->stackCapacity);
+
+    DjuruPool *pool = &vm->djuruPool;
+    give(vm, &pool->smallDjurus, small, sizeof(SmallDjuru));
+}
+
+void MSCFreeDjuruPool(MVM *vm) {
+    DjuruPool *pool = &vm->djuruPool;
+    freeList(vm, &pool->smallDjurus);
+    for (int i = 0; i < DJURU_POOL_BUCKETS; i++) {
+        freeList(vm, &pool->stacks[i]);
+        freeList(vm, &pool->frames[i]);
+    }
+    pool->bytes = 0;
+}
@@ -0,0 +1,54 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#ifndef CPMSC_DJURUPOOL_H
+#define CPMSC_DJURUPOOL_H
+
+#include "../common/constants.h"
+#include "Value.h"
+
+// A djuru small enough to keep its first call frames and its stack in the
+// same allocation as the object. Its [frames] and [stack] point into it until
+// they outgrow it.
+typedef struct {
+    Djuru djuru;
+    CallFrame frames[INITIAL_CALL_FRAMES];
+    Value stack[DJURU_INLINE_SLOTS];
+} SmallDjuru;
+
+// The memory of collected djurus, kept by a VM to build the next ones with.
+// Each free list is linked through the first word of its blocks.
+typedef struct {
+    void *smallDjurus;
+
+    // Stacks and frame arrays, by the power of two of their capacity.
+    void *stacks[DJURU_POOL_BUCKETS];
+    void *frames[DJURU_POOL_BUCKETS];
+
+    // The number of bytes held by all of the lists.
+    size_t bytes;
+} DjuruPool;
+
+// Returns a small djuru that is not initialized yet.
+SmallDjuru *MSCTakeSmallDjuru(MVM *vm);
+
+// Returns a stack of [capacity] slots, which must be a power of two.
+Value *MSCTakeStack(MVM *vm, int capacity);
+
+// Returns an array of [capacity] frames, which must be a power of two.
+CallFrame *MSCTakeFrames(MVM *vm, int capacity);
+
+// Gives [stack], a stack taken from the pool, back to it.
+void MSCGiveStack(MVM *vm, Value *stack, int capacity);
+
+// Gives [frames], a frame array taken from the pool, back to it.
+void MSCGiveFrames(MVM *vm, CallFrame *frames, int capacity);
+
+// Gives the memory of [djuru], which is being collected, back to the pool.
+void MSCGiveDjuru(MVM *vm, Djuru *djuru);
+
+// Frees everything the pool of [vm] holds.
+void MSCFreeDjuruPool(MVM *vm);
+
+#endif //CPMSC_DJURUPOOL_H
@@ -56,6 +56,9 @@ void MSCGCCollect(GC *gc) {
     if (gc->vm->djuru != NULL) {
         MSCGrayObject((Object *) gc->vm->djuru, gc->vm);
     }
+
+    // The djurus waiting in the scheduler.
+    MSCMarkScheduler(gc->vm);
     // The handles.
     for (MSCHandle *handle = gc->vm->handles;
          handle != NULL;
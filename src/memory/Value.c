@@ -7,6 +7,8 @@
 #include "../runtime/MVM.h"
 #include "../builtin/Core.h"
 #include "../runtime/debuger.h"
+#include "../helpers/Number.h"
+#include "DjuruPool.h"
 #include <math.h>
 #include <stdarg.h>
 
@@ -17,7 +19,7 @@ DEFINE_BUFFER(Method, Method);
 
 DEFINE_BUFFER(Field, Field);
 
-#define INITIAL_CALL_FRAMES 4
+DEFINE_BUFFER(Handler, Handler);
 
 
 static void initObj(MVM *vm, Object *obj, ObjType type, Class *classObj) {
@@ -122,62 +124,304 @@ static uint32_t hashValue(Value value) {
 #endif
 }
 
-// Looks for an entry with [key] in an array of [capacity] [entries].
+// Maps are Swiss tables: alongside the entries there is an array of one byte
+// control codes, and probing looks at a whole group of MAP_GROUP_WIDTH control
+// bytes at once. A key's hash is split in two: the high bits ([hashH1]) pick
+// where probing starts and the low 7 bits ([hashH2]) are stored in the
+// control byte of the slot. Only the entries whose control byte matches get
+// their key compared, so a miss usually touches no entry at all.
+static inline uint32_t hashH1(uint32_t hash) {
+    return hash >> 7;
+}
+
+static inline uint8_t hashH2(uint32_t hash) {
+    return (uint8_t) (hash & 0x7f);
+}
+
+// A bit set with bit [i] set for each matching byte [i] of a group.
+typedef uint32_t GroupMask;
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+#include <emmintrin.h>
+
+static inline GroupMask groupMatch(const uint8_t *ctrl, uint8_t h2) {
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+    return (GroupMask) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char) h2)));
+}
+
+static inline GroupMask groupMatchEmpty(const uint8_t *ctrl) {
+    return groupMatch(ctrl, MAP_CTRL_EMPTY);
+}
+
+// Empty and deleted bytes are the only ones with the sign bit set.
+static inline GroupMask groupMatchEmptyOrDeleted(const uint8_t *ctrl) {
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+    return (GroupMask) _mm_movemask_epi8(group);
+}
+
+#else
+
+// Portable fallback working on the group as two 64 bits words.
+#define SWAR_LSBS 0x0101010101010101ull
+#define SWAR_MSBS 0x8080808080808080ull
+
+static inline uint64_t swarLoad(const uint8_t *ctrl) {
+    uint64_t word = 0;
+    for (int i = 7; i >= 0; i--) word = (word << 8) | ctrl[i];
+    return word;
+}
+
+// Packs the high bit of every byte of [word] into the low 8 bits.
+static inline GroupMask swarPack(uint64_t word) {
+    return (GroupMask) ((((word & SWAR_MSBS) >> 7) * 0x0102040810204080ull) >> 56);
+}
+
+// May report false positives, which the key comparison filters out.
+static inline uint64_t swarMatch(uint64_t word, uint8_t h2) {
+    uint64_t x = word ^ (SWAR_LSBS * h2);
+    return (x - SWAR_LSBS) & ~x & SWAR_MSBS;
+}
+
+static inline GroupMask groupMatch(const uint8_t *ctrl, uint8_t h2) {
+    return swarPack(swarMatch(swarLoad(ctrl), h2)) |
+           swarPack(swarMatch(swarLoad(ctrl + 8), h2)) << 8;
+}
+
+static inline GroupMask groupMatchEmpty(const uint8_t *ctrl) {
+    uint64_t low = swarLoad(ctrl), high = swarLoad(ctrl + 8);
+    return swarPack(low & ~(low << 6)) | swarPack(high & ~(high << 6)) << 8;
+}
+
+static inline GroupMask groupMatchEmptyOrDeleted(const uint8_t *ctrl) {
+    return swarPack(swarLoad(ctrl)) | swarPack(swarLoad(ctrl + 8)) << 8;
+}
+
+#endif
+
+// Returns the index of the lowest set bit in the non-zero [mask].
+static inline uint32_t groupMaskLowest(GroupMask mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t) __builtin_ctz(mask);
+#else
+    uint32_t index = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+// Writes the control byte of slot [index], keeping the trailing mirror of
+// the first group in sync.
+static inline void setCtrl(uint8_t *ctrl, uint32_t capacity, uint32_t index, uint8_t value) {
+    ctrl[index] = value;
+    if (index < MAP_GROUP_WIDTH) ctrl[capacity + index] = value;
+}
+
+// The positions of the entries referenced by a hash index are stored right
+// after its control bytes, using the narrowest integer that can hold them.
+static inline uint32_t indexPositionWidth(uint32_t capacity) {
+    return capacity <= 0x100 ? 1 : capacity <= 0x10000 ? 2 : 4;
+}
+
+static inline size_t indexTableSize(uint32_t capacity) {
+    return capacity + MAP_GROUP_WIDTH + (size_t) capacity * indexPositionWidth(capacity);
+}
+
+static inline uint32_t getPosition(const HashIndex *index, uint32_t slot) {
+    const uint8_t *positions = index->ctrl + index->capacity + MAP_GROUP_WIDTH;
+    switch (indexPositionWidth(index->capacity)) {
+        case 1:
+            return positions[slot];
+        case 2:
+            return ((const uint16_t *) positions)[slot];
+        default:
+            return ((const uint32_t *) positions)[slot];
+    }
+}
+
+static inline void setPosition(HashIndex *index, uint32_t slot, uint32_t position) {
+    uint8_t *positions = index->ctrl + index->capacity + MAP_GROUP_WIDTH;
+    switch (indexPositionWidth(index->capacity)) {
+        case 1:
+            positions[slot] = (uint8_t) position;
+            break;
+        case 2:
+            ((uint16_t *) positions)[slot] = (uint16_t) position;
+            break;
+        default:
+            ((uint32_t *) positions)[slot] = position;
+            break;
+    }
+}
+
+// The number of entries a hash index of [capacity] slots can reference
+// before it needs to grow.
+static inline uint32_t indexEntryLimit(uint32_t capacity) {
+    return capacity * MAP_LOAD_PERCENT / 100;
+}
+
+// Map and set entries are runs of [stride] values, the first of which is the
+// key. [keys] points at the first key.
+#define MAP_ENTRY_STRIDE (sizeof(MapEntry) / sizeof(Value))
+#define SET_ENTRY_STRIDE 1
+
+// Looks for an entry with [key] through [index].
 //
-// If found, sets [result] to point to it and returns `true`. Otherwise,
-// returns `false` and points [result] to the entry where the key/value pair
-// should be inserted.
-static bool findEntry(MapEntry *entries, uint32_t capacity, Value key,
-                      MapEntry **result) {
-    // If there is no entry array (an empty map), we definitely won't find it.
-    if (capacity == 0) return false;
-
-    // Figure out where to insert it in the table. Use open addressing and
-    // basic linear probing.
-    uint32_t startIndex = hashValue(key) % capacity;
-    uint32_t index = startIndex;
-
-    // If we pass a tombstone and don't end up finding the key, its entry will
-    // be re-used for the insert.
-    MapEntry *tombstone = NULL;
-
-    // Walk the probe sequence until we've tried every slot.
-    do {
-        MapEntry *entry = &entries[index];
-
-        if (IS_UNDEFINED(entry->key)) {
-            // If we found an empty slot, the key is not in the table. If we found a
-            // slot that contains a deleted key, we have to keep looking.
-            if (IS_FALSE(entry->value)) {
-                // We found an empty slot, so we've reached the end of the probe
-                // sequence without finding the key. If we passed a tombstone, then
-                // that's where we should insert the item, otherwise, put it here at
-                // the end of the sequence.
-                *result = tombstone != NULL ? tombstone : entry;
-                return false;
-            } else {
-                // We found a tombstone. We need to keep looking in case the key is
-                // after it, but we'll use this entry as the insertion point if the
-                // key ends up not being found.
-                if (tombstone == NULL) tombstone = entry;
+// If found, sets [result] to its index slot and returns `true`. Otherwise,
+// returns `false` and sets [result] to the slot where the key should be
+// inserted: the first empty or deleted slot along the probe sequence.
+static bool findEntry(const HashIndex *index, const Value *keys, uint32_t stride,
+                      Value key, uint32_t hash, uint32_t *result) {
+    // If there is no index (an empty table), we definitely won't find it.
+    if (index->capacity == 0) return false;
+
+    uint32_t mask = index->capacity - 1;
+    uint8_t h2 = hashH2(hash);
+    uint32_t position = hashH1(hash) & mask;
+    bool hasInsertSlot = false;
+
+    // Triangular probing over groups visits every group of a power of two
+    // table exactly once.
+    for (uint32_t probe = 0; probe <= index->capacity; probe += MAP_GROUP_WIDTH) {
+        const uint8_t *group = index->ctrl + position;
+
+        GroupMask matches = groupMatch(group, h2);
+        while (matches != 0) {
+            uint32_t slot = (position + groupMaskLowest(matches)) & mask;
+            if (MSCValuesEqual(keys[getPosition(index, slot) * stride], key)) {
+                *result = slot;
+                return true;
             }
-        } else if (MSCValuesEqual(entry->key, key)) {
-            // We found the key.
-            *result = entry;
-            return true;
+            matches &= matches - 1;
         }
 
-        // Try the next slot.
-        index = (index + 1) % capacity;
-    } while (index != startIndex);
+        // If we pass a tombstone and don't end up finding the key, its slot
+        // will be re-used for the insert.
+        if (!hasInsertSlot) {
+            GroupMask free = groupMatchEmptyOrDeleted(group);
+            if (free != 0) {
+                *result = (position + groupMaskLowest(free)) & mask;
+                hasInsertSlot = true;
+            }
+        }
+
+        // An empty slot ends every probe sequence that reached this group, so
+        // the key is not in the table.
+        if (groupMatchEmpty(group) != 0) break;
 
-    // If we get here, the table is full of tombstones. Return the first one we
-    // found.
-    ASSERT(tombstone != NULL, "Map should have tombstones or empty entries.");
-    *result = tombstone;
+        position = (position + probe + MAP_GROUP_WIDTH) & mask;
+    }
+
+    ASSERT(hasInsertSlot, "Hash index should have tombstones or empty slots.");
     return false;
 }
 
+// Points [slot], which must be empty or deleted, at the entry stored at
+// [position].
+static inline void fillSlot(HashIndex *index, uint32_t slot, uint32_t hash, uint32_t position) {
+    if (index->ctrl[slot] == MAP_CTRL_DELETED) index->deleted--;
+    setCtrl(index->ctrl, index->capacity, slot, hashH2(hash));
+    setPosition(index, slot, position);
+}
+
+// Marks [slot] as the tombstone of a removed entry.
+static inline void clearSlot(HashIndex *index, uint32_t slot) {
+    setCtrl(index->ctrl, index->capacity, slot, MAP_CTRL_DELETED);
+    index->deleted++;
+}
+
+// Replaces [index] with a fresh one of [capacity] slots referencing the
+// first [used] entries at [keys]. Removed entries must have been squeezed out
+// first.
+static void rebuildIndex(MVM *vm, HashIndex *index, uint32_t capacity,
+                         const Value *keys, uint32_t stride, uint32_t used) {
+    ASSERT((capacity & (capacity - 1)) == 0, "Hash index capacity must be a power of two.");
+    ASSERT(used <= indexEntryLimit(capacity), "Hash index is too small for its entries.");
+
+    uint8_t *ctrl = (uint8_t *) MSCReallocate(vm->gc, NULL, 0, indexTableSize(capacity));
+    memset(ctrl, MAP_CTRL_EMPTY, capacity + MAP_GROUP_WIDTH);
+
+    DEALLOCATE(vm, index->ctrl);
+    index->ctrl = ctrl;
+    index->capacity = capacity;
+    index->deleted = 0;
+
+    // Keys are known to be distinct, so this only needs the first free slot of
+    // each probe sequence.
+    for (uint32_t i = 0; i < used; i++) {
+        uint32_t hash = hashValue(keys[i * stride]);
+        uint32_t slot;
+        findEntry(index, keys, stride, UNDEFINED_VAL, hash, &slot);
+        fillSlot(index, slot, hash, i);
+    }
+}
+
+static void freeIndex(MVM *vm, HashIndex *index) {
+    DEALLOCATE(vm, index->ctrl);
+    index->ctrl = NULL;
+    index->capacity = 0;
+    index->deleted = 0;
+}
+
+// Squeezes out the holes left by removed entries among the first [used] ones
+// at [keys], keeping the insertion order of the others. Returns how many are
+// left.
+static uint32_t compactEntries(Value *keys, uint32_t stride, uint32_t used) {
+    uint32_t to = 0;
+    for (uint32_t from = 0; from < used; from++) {
+        if (IS_UNDEFINED(keys[from * stride])) continue;
+        if (to != from) memcpy(&keys[to * stride], &keys[from * stride], sizeof(Value) * stride);
+        to++;
+    }
+    return to;
+}
+
+// Returns [used] minus the holes at its end, which can be handed back right
+// away.
+static uint32_t trimHoles(const Value *keys, uint32_t stride, uint32_t used) {
+    while (used > 0 && IS_UNDEFINED(keys[(used - 1) * stride])) used--;
+    return used;
+}
+
+// Works out how a table whose entries are full can make room for one more.
+// Returns `true` if enough entries were removed that squeezing them out is
+// worth it. Otherwise sets [capacity] and [indexCapacity] to the grown
+// sizes.
+static bool planRoom(uint32_t count, uint32_t used, uint32_t *capacity, uint32_t *indexCapacity) {
+    uint32_t holes = used - count;
+    if (holes > 0 && holes >= used / 4) return true;
+
+    if (*indexCapacity < MAP_MIN_CAPACITY) *indexCapacity = MAP_MIN_CAPACITY;
+    if (*capacity >= indexEntryLimit(*indexCapacity)) *indexCapacity *= MAP_GROW_FACTOR;
+
+    *capacity *= MAP_GROW_FACTOR;
+    if (*capacity < MAP_MIN_ENTRIES) *capacity = MAP_MIN_ENTRIES;
+    if (*capacity > indexEntryLimit(*indexCapacity)) *capacity = indexEntryLimit(*indexCapacity);
+    return false;
+}
+
+// Returns the capacity [index] must be rebuilt at before one more entry is
+// inserted into a table with [count] live entries, or zero if it still has
+// enough empty slots. Misses only stop at an empty slot, so the tombstones
+// left by removals count against the load. Rebuilding at the same capacity
+// only pays off if it frees at least half of the index, otherwise it grows.
+static inline uint32_t tombstoneRehashCapacity(uint32_t count, const HashIndex *index) {
+    uint32_t limit = indexEntryLimit(index->capacity);
+    if (index->deleted == 0 || count + index->deleted + 1 <= limit) return 0;
+    return count < limit / 2 ? index->capacity : index->capacity * MAP_GROW_FACTOR;
+}
+
+// Returns `true` if a table with [count] live entries has shrunk enough for
+// its index to be halved. The halved index is left at most half full, so that
+// a table hovering around one size does not keep growing and shrinking.
+static inline bool shouldShrink(uint32_t count, const HashIndex *index) {
+    return index->capacity > MAP_MIN_CAPACITY &&
+           count < indexEntryLimit(index->capacity / MAP_GROW_FACTOR) / 2;
+}
+
 Class *MSCSingleClass(MVM *vm, int numFields, String *name) {
     Class *classObj = ALLOCATE(vm, Class);
     initObj(vm, &classObj->obj, OBJ_CLASS, NULL);
@@ -344,6 +588,24 @@ void MSCBlackenObject(Object *thisObj, MVM *vm) {
         case OBJ_MAP:
             MSCBlackenMap((Map *) thisObj, vm);
             break;
+        case OBJ_SET:
+            MSCBlackenSet((Set *) thisObj, vm);
+            break;
+        case OBJ_TYPED_ARRAY:
+            MSCBlackenTypedArray((TypedArray *) thisObj, vm);
+            break;
+        case OBJ_DEQUE:
+            MSCBlackenDeque((Deque *) thisObj, vm);
+            break;
+        case OBJ_HEAP:
+            MSCBlackenHeap((Heap *) thisObj, vm);
+            break;
+        case OBJ_CHANNEL:
+            MSCBlackenChannel((Channel *) thisObj, vm);
+            break;
+        case OBJ_GENERATOR:
+            MSCBlackenGenerator((Generator *) thisObj, vm);
+            break;
         case OBJ_MODULE:
             MSCBlackenModule((Module *) thisObj, vm);
             break;
@@ -370,17 +632,17 @@ void MSCFreeObject(Object *thisObj, MVM *vm) {
             MSCFreeMethodBuffer(vm, &((Class *) thisObj)->methods);
             break;
 
-        case OBJ_THREAD: {
-            DEALLOCATE(vm, ((Djuru *) thisObj)->frames);
-            DEALLOCATE(vm, ((Djuru *) thisObj)->stack);
-            break;
-        }
+        case OBJ_THREAD:
+            // The pool owns the djuru from here.
+            MSCGiveDjuru(vm, (Djuru *) thisObj);
+            return;
 
         case OBJ_FN: {
             Function *fn = (Function *) thisObj;
 
             MSCFreeValueBuffer(vm, &fn->constants);
             MSCFreeByteBuffer(vm, &fn->code);
+            MSCFreeHandlerBuffer(vm, &fn->handlers);
             MSCFreeIntBuffer(vm, &fn->debug->sourceLines);
             DEALLOCATE(vm, fn->debug->name);
             DEALLOCATE(vm, fn->debug);
@@ -397,6 +659,12 @@ void MSCFreeObject(Object *thisObj, MVM *vm) {
 
         case OBJ_MAP:
             DEALLOCATE(vm, ((Map *) thisObj)->entries);
+            DEALLOCATE(vm, ((Map *) thisObj)->index.ctrl);
+            break;
+
+        case OBJ_SET:
+            DEALLOCATE(vm, ((Set *) thisObj)->keys);
+            DEALLOCATE(vm, ((Set *) thisObj)->index.ctrl);
             break;
 
         case OBJ_MODULE:
@@ -418,6 +686,21 @@ void MSCFreeObject(Object *thisObj, MVM *vm) {
             break;
         case OBJ_RANGE:
             break;
+        case OBJ_TYPED_ARRAY:
+            // The elements are allocated along with the object.
+            break;
+        case OBJ_DEQUE:
+            DEALLOCATE(vm, ((Deque *) thisObj)->data);
+            break;
+        case OBJ_HEAP:
+            MSCFreeValueBuffer(vm, &((Heap *) thisObj)->entries);
+            break;
+        case OBJ_CHANNEL:
+            MSCFreeChannel((Channel *) thisObj, vm);
+            break;
+        case OBJ_GENERATOR:
+            // The slots are allocated along with the object.
+            break;
     }
     // delete this;
     DEALLOCATE(vm, thisObj);
@@ -493,26 +776,42 @@ void MSCBlackenUpvalue(Upvalue *upvalue, MVM *vm) {
 
 
 Djuru *MSCDjuruFrom(MVM *vm, Closure *closure) {
-    // Allocate the arrays before the fiber in case it triggers a GC.
-    CallFrame *frames = ALLOCATE_ARRAY(vm, CallFrame, INITIAL_CALL_FRAMES);
     // Add one slot for the unused implicit receiver slot that the compiler
     // assumes all functions have.
     int stackCapacity = closure == NULL ? 1 : powerOf2Ceil(closure->fn->maxSlots + 1);
-    Djuru *thread = ALLOCATE(vm, Djuru);
+
+    Djuru *thread;
+    if (stackCapacity <= DJURU_INLINE_SLOTS) {
+        // Most djurus run small closures, so keep everything in one block.
+        SmallDjuru *small = MSCTakeSmallDjuru(vm);
+        thread = &small->djuru;
+        thread->small = true;
+        thread->stack = small->stack;
+        thread->stackCapacity = DJURU_INLINE_SLOTS;
+        thread->frames = small->frames;
+    } else {
+        // Allocate the arrays before the fiber in case it triggers a GC.
+        CallFrame *frames = MSCTakeFrames(vm, INITIAL_CALL_FRAMES);
+        Value *stack = MSCTakeStack(vm, stackCapacity);
+        thread = ALLOCATE(vm, Djuru);
+        thread->small = false;
+        thread->stack = stack;
+        thread->stackCapacity = stackCapacity;
+        thread->frames = frames;
+    }
     initObj(vm, &thread->obj, OBJ_THREAD, vm->core.djuruClass);
     MSCPushRoot(vm->gc, (Object *) thread);
 
-    Value *stack = ALLOCATE_ARRAY(vm, Value, stackCapacity);
-    thread->stack = stack;
     thread->stackTop = thread->stack;
-    thread->stackCapacity = stackCapacity;
-
-    thread->frames = frames;
     thread->frameCapacity = INITIAL_CALL_FRAMES;
     thread->numOfFrames = 0;
 
     thread->openUpvalues = NULL;
     thread->caller = NULL;
+    thread->waiters = NULL;
+    thread->nextWaiter = NULL;
+    thread->scheduled = false;
+    thread->preempted = false;
     thread->error = NULL_VAL;
     thread->state = DJURU_OTHER;
 
@@ -554,10 +853,26 @@ void MSCBlackenDjuru(Djuru *djuru, MVM *vm) {
     MSCGrayObject((Object *) djuru->caller, vm);
     MSCGrayValue(vm, djuru->error);
 
-    // Keep track of how much memory is still in use.
-    vm->gc->bytesAllocated += sizeof(Djuru);
-    vm->gc->bytesAllocated += djuru->frameCapacity * sizeof(CallFrame);
-    vm->gc->bytesAllocated += djuru->stackCapacity * sizeof(Value);
+    // The djurus waiting for it, and the next one waiting with it.
+    MSCGrayObject((Object *) djuru->waiters, vm);
+    MSCGrayObject((Object *) djuru->nextWaiter, vm);
+
+    // Keep track of how much memory is still in use. A small djuru only
+    // counts the arrays it has outgrown on top of itself.
+    if (djuru->small) {
+        SmallDjuru *small = (SmallDjuru *) djuru;
+        vm->gc->bytesAllocated += sizeof(SmallDjuru);
+        if (djuru->frames != small->frames) {
+            vm->gc->bytesAllocated += djuru->frameCapacity * sizeof(CallFrame);
+        }
+        if (djuru->stack != small->stack) {
+            vm->gc->bytesAllocated += djuru->stackCapacity * sizeof(Value);
+        }
+    } else {
+        vm->gc->bytesAllocated += sizeof(Djuru);
+        vm->gc->bytesAllocated += djuru->frameCapacity * sizeof(CallFrame);
+        vm->gc->bytesAllocated += djuru->stackCapacity * sizeof(Value);
+    }
 }
 
 
@@ -565,37 +880,41 @@ void MSCEnsureStack(Djuru *djuru, MVM *vm, int needed) {
     if (djuru->stackCapacity >= needed) return;
 
     int capacity = powerOf2Ceil(needed);
+    int oldCapacity = djuru->stackCapacity;
     Value *oldStack = djuru->stack;
-    djuru->stack = (Value *) MSCReallocate(vm->gc, djuru->stack,
-                                           sizeof(Value) * djuru->stackCapacity,
-                                           sizeof(Value) * capacity);
+    djuru->stack = MSCTakeStack(vm, capacity);
     djuru->stackCapacity = capacity;
+    memcpy(djuru->stack, oldStack, sizeof(Value) * (djuru->stackTop - oldStack));
 
-    // If the reallocation moves the stack, then we need to recalculate every
-    // pointer that points into the old stack to into the same relative distance
-    // in the new stack. We have to be a little careful about how these are
-    // calculated because pointer subtraction is only well-defined within a
-    // single array, hence the slightly redundant-looking arithmetic below.
-    if (djuru->stack != oldStack) {
-        // Top of the stack.
-        if (vm->apiStack >= oldStack && vm->apiStack <= djuru->stackTop) {
-            vm->apiStack = djuru->stack + (vm->apiStack - oldStack);
-        }
+    // The stack has moved, so we need to recalculate every pointer that points
+    // into the old stack to into the same relative distance in the new stack.
+    // We have to be a little careful about how these are calculated because
+    // pointer subtraction is only well-defined within a single array, hence the
+    // slightly redundant-looking arithmetic below.
 
-        // Stack pointer for each call frame.
-        for (int i = 0; i < djuru->numOfFrames; i++) {
-            CallFrame *frame = &djuru->frames[i];
-            frame->stackStart = djuru->stack + (frame->stackStart - oldStack);
-        }
+    // Top of the stack.
+    if (vm->apiStack >= oldStack && vm->apiStack <= djuru->stackTop) {
+        vm->apiStack = djuru->stack + (vm->apiStack - oldStack);
+    }
 
-        // Open upvalues.
-        for (Upvalue *upvalue = djuru->openUpvalues;
-             upvalue != NULL;
-             upvalue = upvalue->next) {
-            upvalue->value = djuru->stack + (upvalue->value - oldStack);
-        }
+    // Stack pointer for each call frame.
+    for (int i = 0; i < djuru->numOfFrames; i++) {
+        CallFrame *frame = &djuru->frames[i];
+        frame->stackStart = djuru->stack + (frame->stackStart - oldStack);
+    }
+
+    // Open upvalues.
+    for (Upvalue *upvalue = djuru->openUpvalues;
+         upvalue != NULL;
+         upvalue = upvalue->next) {
+        upvalue->value = djuru->stack + (upvalue->value - oldStack);
+    }
 
-        djuru->stackTop = djuru->stack + (djuru->stackTop - oldStack);
+    djuru->stackTop = djuru->stack + (djuru->stackTop - oldStack);
+
+    // A small djuru's first stack is part of it.
+    if (!djuru->small || oldStack != ((SmallDjuru *) djuru)->stack) {
+        MSCGiveStack(vm, oldStack, oldCapacity);
     }
 }
 
@@ -739,19 +1058,27 @@ Value MSCListRemoveAt(List *list, MVM *vm, uint32_t index) {
     return removed;
 }
 
+static inline void initIndex(HashIndex *index) {
+    index->capacity = 0;
+    index->deleted = 0;
+    index->ctrl = NULL;
+}
+
 Map *MSCMapFrom(MVM *vm) {
     Map *map = ALLOCATE(vm, Map);
     initObj(vm, &map->obj, OBJ_MAP, vm->core.mapClass != NULL ? vm->core.mapClass : NULL);
     map->capacity = 0;
     map->count = 0;
+    map->used = 0;
     map->entries = NULL;
+    initIndex(&map->index);
     return map;
 }
 
 void MSCBlackenMap(Map *map, MVM *vm) {
     // Object::blacken(vm);
     // Mark the entries.
-    for (uint32_t i = 0; i < map->capacity; i++) {
+    for (uint32_t i = 0; i < map->used; i++) {
         MapEntry *entry = &map->entries[i];
         if (IS_UNDEFINED(entry->key)) continue;
 
@@ -762,59 +1089,42 @@ void MSCBlackenMap(Map *map, MVM *vm) {
     // Keep track of how much memory is still in use.
     vm->gc->bytesAllocated += sizeof(Map);
     vm->gc->bytesAllocated += sizeof(MapEntry) * map->capacity;
+    if (map->index.capacity > 0) vm->gc->bytesAllocated += indexTableSize(map->index.capacity);
 }
 
+static inline Value *mapKeys(Map *map) {
+    return (Value *) map->entries;
+}
 
-bool insertEntries(MapEntry *entries, uint32_t capacitry, Value key, Value value) {
-    ASSERT(entries != NULL, "Should ensure capacity before inserting.");
-
-    MapEntry *entry;
-    if (findEntry(entries, capacitry, key, &entry)) {
-        // Already present, so just replace the value.
-        entry->value = value;
-        return false;
-    } else {
-        entry->key = key;
-        entry->value = value;
-        return true;
-    }
+static void resizeMapEntries(Map *map, MVM *vm, uint32_t capacity) {
+    map->entries = (MapEntry *) MSCReallocate(vm->gc, map->entries,
+                                              sizeof(MapEntry) * map->capacity,
+                                              sizeof(MapEntry) * capacity);
+    map->capacity = capacity;
 }
 
-void MSCMapResize(Map *map, MVM *vm, uint32_t capacity) {
-// Create the new empty hash table.
-    MapEntry *entries = ALLOCATE_ARRAY(vm, MapEntry, capacity);
-    for (uint32_t i = 0; i < capacity; i++) {
-        entries[i].key = UNDEFINED_VAL;
-        entries[i].value = FALSE_VAL;
+void MSCMapResize(Map *map, MVM *vm, uint32_t indexCapacity) {
+    if (map->used > map->count) {
+        map->used = compactEntries(mapKeys(map), MAP_ENTRY_STRIDE, map->used);
     }
 
-    // Re-add the existing entries.
-    if (map->capacity > 0) {
-        for (uint32_t i = 0; i < map->capacity; i++) {
-            MapEntry *entry = &map->entries[i];
+    uint32_t limit = indexEntryLimit(indexCapacity);
+    if (map->capacity > limit) resizeMapEntries(map, vm, limit);
 
-            // Don't copy empty entries or tombstones.
-            if (IS_UNDEFINED(entry->key)) continue;
-
-            insertEntries(entries, capacity, entry->key, entry->value);
-        }
-    }
-
-    // Replace the array.
-    DEALLOCATE(vm, map->entries);
-    map->entries = entries;
-    map->capacity = capacity;
+    rebuildIndex(vm, &map->index, indexCapacity, mapKeys(map), MAP_ENTRY_STRIDE, map->used);
 }
 
 Value MSCMapGet(Map *map, Value key) {
-    MapEntry *entry;
-    if (findEntry(map->entries, map->capacity, key, &entry)) return entry->value;
+    uint32_t slot;
+    if (findEntry(&map->index, mapKeys(map), MAP_ENTRY_STRIDE, key, hashValue(key), &slot)) {
+        return map->entries[getPosition(&map->index, slot)].value;
+    }
 
     return UNDEFINED_VAL;
 }
 
 void MSCMapAddAll(Map *map, MVM *vm, Map *other) {
-    for (uint32_t i = 0; i < other->capacity; i++) {
+    for (uint32_t i = 0; i < other->used; i++) {
         MapEntry *entry = &other->entries[i];
         if (IS_UNDEFINED(entry->key)) continue;
         MSCMapSet(map, vm, entry->key, entry->value);
@@ -822,18 +1132,41 @@ void MSCMapAddAll(Map *map, MVM *vm, Map *other) {
 }
 
 void MSCMapSet(Map *map, MVM *vm, Value key, Value value) {
-// If the map is getting too full, make room first.
-    if (map->count + 1 > map->capacity * MAP_LOAD_PERCENT / 100) {
-        // Figure out the new hash table size.
-        uint32_t capacity = map->capacity * MAP_GROW_FACTOR;
-        if (capacity < MAP_MIN_CAPACITY) capacity = MAP_MIN_CAPACITY;
+    uint32_t hash = hashValue(key);
+    uint32_t slot;
+    if (findEntry(&map->index, mapKeys(map), MAP_ENTRY_STRIDE, key, hash, &slot)) {
+        // Already present, so just replace the value.
+        map->entries[getPosition(&map->index, slot)].value = value;
+        return;
+    }
 
-        MSCMapResize(map, vm, capacity);
+    // If the entries are full, or the index is clogged with tombstones, make
+    // room first. That may rebuild the index, so look the insertion slot up
+    // again.
+    if (map->used == map->capacity) {
+        uint32_t capacity = map->capacity;
+        uint32_t indexCapacity = map->index.capacity;
+        if (planRoom(map->count, map->used, &capacity, &indexCapacity)) {
+            MSCMapResize(map, vm, map->index.capacity);
+        } else {
+            resizeMapEntries(map, vm, capacity);
+            if (indexCapacity != map->index.capacity) MSCMapResize(map, vm, indexCapacity);
+        }
+        findEntry(&map->index, mapKeys(map), MAP_ENTRY_STRIDE, UNDEFINED_VAL, hash, &slot);
     }
-    if (insertEntries(map->entries, map->capacity, key, value)) {
-        // A new key was added.
-        map->count++;
+
+    uint32_t rehashCapacity = tombstoneRehashCapacity(map->count, &map->index);
+    if (rehashCapacity != 0) {
+        MSCMapResize(map, vm, rehashCapacity);
+        findEntry(&map->index, mapKeys(map), MAP_ENTRY_STRIDE, UNDEFINED_VAL, hash, &slot);
     }
+
+    // A new key was added.
+    uint32_t position = map->used++;
+    map->entries[position].key = key;
+    map->entries[position].value = value;
+    fillSlot(&map->index, slot, hash, position);
+    map->count++;
 }
 
 void MSCMapClear(Map *map, MVM *vm) {
@@ -841,39 +1174,442 @@ void MSCMapClear(Map *map, MVM *vm) {
     map->entries = NULL;
     map->capacity = 0;
     map->count = 0;
+    map->used = 0;
+    freeIndex(vm, &map->index);
 }
 
 Value MSCMapRemove(Map *map, MVM *vm, Value key) {
-    MapEntry *entry;
-    if (!findEntry(map->entries, map->capacity, key, &entry)) return NULL_VAL;
+    uint32_t slot;
+    if (!findEntry(&map->index, mapKeys(map), MAP_ENTRY_STRIDE, key, hashValue(key), &slot)) return NULL_VAL;
 
-    // Remove the entry from the map. Set map value to true, which marks it as a
-    // deleted slot. When searching for a key, we will stop on empty slots, but
-    // continue past deleted slots.
+    // Remove the entry from the map, leaving a hole in the entries and a
+    // tombstone in the index. When searching for a key, we will stop on
+    // groups with an empty slot, but continue past deleted slots.
+    MapEntry *entry = &map->entries[getPosition(&map->index, slot)];
     Value value = entry->value;
     entry->key = UNDEFINED_VAL;
-    entry->value = TRUE_VAL;
+    entry->value = NULL_VAL;
+    clearSlot(&map->index, slot);
+    map->used = trimHoles(mapKeys(map), MAP_ENTRY_STRIDE, map->used);
 
     if (IS_OBJ(value)) MSCPushRoot(vm->gc, AS_OBJ(value));
     map->count--;
 
     if (map->count == 0) {
-        // Removed the last item, so free the array.
+        // Removed the last item, so free the arrays.
         MSCMapClear(map, vm);
-    } else if (map->capacity > MAP_MIN_CAPACITY &&
-               map->count < map->capacity / MAP_GROW_FACTOR * MAP_LOAD_PERCENT / 100) {
-        uint32_t capacity = map->capacity / MAP_GROW_FACTOR;
-        if (capacity < MAP_MIN_CAPACITY) capacity = MAP_MIN_CAPACITY;
-
-        // The map is getting empty, so shrink the entry array back down.
-        // TODO: Should we do map less aggressively than we grow?
-        MSCMapResize(map, vm, capacity);
+    } else if (shouldShrink(map->count, &map->index)) {
+        // The map is getting empty, so shrink the index and the entries back
+        // down.
+        MSCMapResize(map, vm, map->index.capacity / MAP_GROW_FACTOR);
     }
 
     if (IS_OBJ(value)) MSCPopRoot(vm->gc);
     return value;
 }
 
+Set *MSCSetFrom(MVM *vm) {
+    Set *set = ALLOCATE(vm, Set);
+    initObj(vm, &set->obj, OBJ_SET, vm->core.setClass);
+    set->capacity = 0;
+    set->count = 0;
+    set->used = 0;
+    set->keys = NULL;
+    initIndex(&set->index);
+    return set;
+}
+
+void MSCBlackenSet(Set *set, MVM *vm) {
+    for (uint32_t i = 0; i < set->used; i++) {
+        if (IS_UNDEFINED(set->keys[i])) continue;
+        MSCGrayValue(vm, set->keys[i]);
+    }
+
+    vm->gc->bytesAllocated += sizeof(Set);
+    vm->gc->bytesAllocated += sizeof(Value) * set->capacity;
+    if (set->index.capacity > 0) vm->gc->bytesAllocated += indexTableSize(set->index.capacity);
+}
+
+static void resizeSetKeys(Set *set, MVM *vm, uint32_t capacity) {
+    set->keys = (Value *) MSCReallocate(vm->gc, set->keys,
+                                        sizeof(Value) * set->capacity,
+                                        sizeof(Value) * capacity);
+    set->capacity = capacity;
+}
+
+static void resizeSet(Set *set, MVM *vm, uint32_t indexCapacity) {
+    if (set->used > set->count) {
+        set->used = compactEntries(set->keys, SET_ENTRY_STRIDE, set->used);
+    }
+
+    uint32_t limit = indexEntryLimit(indexCapacity);
+    if (set->capacity > limit) resizeSetKeys(set, vm, limit);
+
+    rebuildIndex(vm, &set->index, indexCapacity, set->keys, SET_ENTRY_STRIDE, set->used);
+}
+
+bool MSCSetContains(Set *set, Value key) {
+    uint32_t slot;
+    return findEntry(&set->index, set->keys, SET_ENTRY_STRIDE, key, hashValue(key), &slot);
+}
+
+bool MSCSetAdd(Set *set, MVM *vm, Value key) {
+    uint32_t hash = hashValue(key);
+    uint32_t slot;
+    if (findEntry(&set->index, set->keys, SET_ENTRY_STRIDE, key, hash, &slot)) return false;
+
+    if (set->used == set->capacity) {
+        uint32_t capacity = set->capacity;
+        uint32_t indexCapacity = set->index.capacity;
+        if (planRoom(set->count, set->used, &capacity, &indexCapacity)) {
+            resizeSet(set, vm, set->index.capacity);
+        } else {
+            resizeSetKeys(set, vm, capacity);
+            if (indexCapacity != set->index.capacity) resizeSet(set, vm, indexCapacity);
+        }
+        findEntry(&set->index, set->keys, SET_ENTRY_STRIDE, UNDEFINED_VAL, hash, &slot);
+    }
+
+    uint32_t rehashCapacity = tombstoneRehashCapacity(set->count, &set->index);
+    if (rehashCapacity != 0) {
+        resizeSet(set, vm, rehashCapacity);
+        findEntry(&set->index, set->keys, SET_ENTRY_STRIDE, UNDEFINED_VAL, hash, &slot);
+    }
+
+    uint32_t position = set->used++;
+    set->keys[position] = key;
+    fillSlot(&set->index, slot, hash, position);
+    set->count++;
+    return true;
+}
+
+void MSCSetClear(Set *set, MVM *vm) {
+    DEALLOCATE(vm, set->keys);
+    set->keys = NULL;
+    set->capacity = 0;
+    set->count = 0;
+    set->used = 0;
+    freeIndex(vm, &set->index);
+}
+
+bool MSCSetRemove(Set *set, MVM *vm, Value key) {
+    uint32_t slot;
+    if (!findEntry(&set->index, set->keys, SET_ENTRY_STRIDE, key, hashValue(key), &slot)) return false;
+
+    set->keys[getPosition(&set->index, slot)] = UNDEFINED_VAL;
+    clearSlot(&set->index, slot);
+    set->used = trimHoles(set->keys, SET_ENTRY_STRIDE, set->used);
+    set->count--;
+
+    if (set->count == 0) {
+        MSCSetClear(set, vm);
+    } else if (shouldShrink(set->count, &set->index)) {
+        resizeSet(set, vm, set->index.capacity / MAP_GROW_FACTOR);
+    }
+    return true;
+}
+
+size_t MSCTypedArrayElementSize(TypedArrayKind kind) {
+    switch (kind) {
+        case TYPED_FLOAT64: return sizeof(double);
+        case TYPED_INT32: return sizeof(int32_t);
+        case TYPED_UINT8: return sizeof(uint8_t);
+    }
+    return 0;
+}
+
+static Class *typedArrayClass(MVM *vm, TypedArrayKind kind) {
+    switch (kind) {
+        case TYPED_FLOAT64: return vm->core.float64ArrayClass;
+        case TYPED_INT32: return vm->core.int32ArrayClass;
+        case TYPED_UINT8: return vm->core.uint8ArrayClass;
+    }
+    return NULL;
+}
+
+TypedArray *MSCTypedArrayFrom(MVM *vm, TypedArrayKind kind, uint32_t count) {
+    size_t size = MSCTypedArrayElementSize(kind) * count;
+
+    // The elements live in the same allocation, right after the object.
+    TypedArray *array = ALLOCATE_FLEX(vm, TypedArray, uint8_t, size);
+    initObj(vm, &array->obj, OBJ_TYPED_ARRAY, typedArrayClass(vm, kind));
+    array->kind = kind;
+    array->count = count;
+    array->data = array + 1;
+    array->owner = NULL;
+    memset(array->data, 0, size);
+    return array;
+}
+
+TypedArray *MSCTypedArrayView(MVM *vm, TypedArray *source, uint32_t start, uint32_t count) {
+    TypedArray *view = ALLOCATE(vm, TypedArray);
+    initObj(vm, &view->obj, OBJ_TYPED_ARRAY, source->obj.classObj);
+    view->kind = source->kind;
+    view->count = count;
+    view->data = (uint8_t *) source->data + MSCTypedArrayElementSize(source->kind) * start;
+    // Point at the array that owns the storage so views of views do not keep
+    // the intermediate views alive.
+    view->owner = source->owner != NULL ? source->owner : (Object *) source;
+    return view;
+}
+
+void MSCBlackenTypedArray(TypedArray *array, MVM *vm) {
+    if (array->owner != NULL) {
+        MSCGrayObject(array->owner, vm);
+        vm->gc->bytesAllocated += sizeof(TypedArray);
+    } else {
+        vm->gc->bytesAllocated += sizeof(TypedArray) + MSCTypedArrayElementSize(array->kind) * array->count;
+    }
+}
+
+double MSCTypedArrayGet(const TypedArray *array, uint32_t index) {
+    switch (array->kind) {
+        case TYPED_FLOAT64: return ((const double *) array->data)[index];
+        case TYPED_INT32: return ((const int32_t *) array->data)[index];
+        case TYPED_UINT8: return ((const uint8_t *) array->data)[index];
+    }
+    return 0;
+}
+
+uint32_t MSCNumToUint32(double value) {
+    if (isnan(value) || isinf(value)) return 0;
+    value = fmod(trunc(value), 4294967296.0);
+    if (value < 0) value += 4294967296.0;
+    return (uint32_t) value;
+}
+
+void MSCTypedArraySet(TypedArray *array, uint32_t index, double value) {
+    switch (array->kind) {
+        case TYPED_FLOAT64:
+            ((double *) array->data)[index] = value;
+            break;
+        case TYPED_INT32:
+            ((int32_t *) array->data)[index] = (int32_t) MSCNumToUint32(value);
+            break;
+        case TYPED_UINT8:
+            ((uint8_t *) array->data)[index] = (uint8_t) MSCNumToUint32(value);
+            break;
+    }
+}
+
+Deque *MSCDequeFrom(MVM *vm) {
+    Deque *deque = ALLOCATE(vm, Deque);
+    initObj(vm, &deque->obj, OBJ_DEQUE, vm->core.dequeClass);
+    deque->capacity = 0;
+    deque->head = 0;
+    deque->count = 0;
+    deque->data = NULL;
+    return deque;
+}
+
+void MSCBlackenDeque(Deque *deque, MVM *vm) {
+    for (uint32_t i = 0; i < deque->count; i++) {
+        MSCGrayValue(vm, *MSCDequeAt(deque, i));
+    }
+
+    vm->gc->bytesAllocated += sizeof(Deque);
+    vm->gc->bytesAllocated += sizeof(Value) * deque->capacity;
+}
+
+// Moves the elements of [deque] to a new ring buffer of [capacity], starting
+// at position 0.
+static void resizeDeque(Deque *deque, MVM *vm, uint32_t capacity) {
+    Value *data = capacity == 0 ? NULL : ALLOCATE_ARRAY(vm, Value, capacity);
+    for (uint32_t i = 0; i < deque->count; i++) {
+        data[i] = *MSCDequeAt(deque, i);
+    }
+
+    DEALLOCATE(vm, deque->data);
+    deque->data = data;
+    deque->capacity = capacity;
+    deque->head = 0;
+}
+
+static inline void growDeque(Deque *deque, MVM *vm) {
+    if (deque->count < deque->capacity) return;
+    resizeDeque(deque, vm, deque->capacity == 0 ? DEQUE_MIN_CAPACITY : deque->capacity * LIST_GROW_FACTOR);
+}
+
+// Gives back half of the ring buffer once it is less than a quarter full, so
+// that alternating pushes and pops at the boundary don't keep resizing.
+static inline void shrinkDeque(Deque *deque, MVM *vm) {
+    if (deque->capacity > DEQUE_MIN_CAPACITY && deque->count < deque->capacity / 4) {
+        resizeDeque(deque, vm, deque->capacity / LIST_GROW_FACTOR);
+    }
+}
+
+void MSCDequePushBack(Deque *deque, MVM *vm, Value value) {
+    if (IS_OBJ(value)) MSCPushRoot(vm->gc, AS_OBJ(value));
+    growDeque(deque, vm);
+    if (IS_OBJ(value)) MSCPopRoot(vm->gc);
+
+    deque->count++;
+    *MSCDequeAt(deque, deque->count - 1) = value;
+}
+
+void MSCDequePushFront(Deque *deque, MVM *vm, Value value) {
+    if (IS_OBJ(value)) MSCPushRoot(vm->gc, AS_OBJ(value));
+    growDeque(deque, vm);
+    if (IS_OBJ(value)) MSCPopRoot(vm->gc);
+
+    deque->head = (deque->head - 1) & (deque->capacity - 1);
+    deque->count++;
+    deque->data[deque->head] = value;
+}
+
+Value MSCDequePopBack(Deque *deque, MVM *vm) {
+    Value removed = *MSCDequeAt(deque, deque->count - 1);
+    deque->count--;
+
+    if (IS_OBJ(removed)) MSCPushRoot(vm->gc, AS_OBJ(removed));
+    shrinkDeque(deque, vm);
+    if (IS_OBJ(removed)) MSCPopRoot(vm->gc);
+    return removed;
+}
+
+Value MSCDequePopFront(Deque *deque, MVM *vm) {
+    Value removed = deque->data[deque->head];
+    deque->head = (deque->head + 1) & (deque->capacity - 1);
+    deque->count--;
+
+    if (IS_OBJ(removed)) MSCPushRoot(vm->gc, AS_OBJ(removed));
+    shrinkDeque(deque, vm);
+    if (IS_OBJ(removed)) MSCPopRoot(vm->gc);
+    return removed;
+}
+
+void MSCDequeClear(Deque *deque, MVM *vm) {
+    DEALLOCATE(vm, deque->data);
+    deque->data = NULL;
+    deque->capacity = 0;
+    deque->head = 0;
+    deque->count = 0;
+}
+
+Heap *MSCHeapFrom(MVM *vm, Value comparer) {
+    Heap *heap = ALLOCATE(vm, Heap);
+    initObj(vm, &heap->obj, OBJ_HEAP, vm->core.heapClass);
+    MSCInitValueBuffer(&heap->entries);
+    heap->comparer = comparer;
+    heap->order = IS_NULL(comparer) ? HEAP_ORDER_ANY : HEAP_ORDER_SCRIPT;
+    return heap;
+}
+
+void MSCBlackenHeap(Heap *heap, MVM *vm) {
+    MSCGrayBuffer(vm, &heap->entries);
+    MSCGrayValue(vm, heap->comparer);
+
+    vm->gc->bytesAllocated += sizeof(Heap);
+    vm->gc->bytesAllocated += sizeof(Value) * heap->entries.capacity;
+}
+
+Channel *MSCChannelFrom(MVM *vm, uint32_t capacity) {
+    Value *buffer = capacity == 0 ? NULL : ALLOCATE_ARRAY(vm, Value, capacity);
+    Channel *channel = ALLOCATE(vm, Channel);
+    initObj(vm, &channel->obj, OBJ_CHANNEL, vm->core.channelClass);
+    channel->capacity = capacity;
+    channel->head = 0;
+    channel->count = 0;
+    channel->buffer = buffer;
+    channel->closed = false;
+    channel->senders.head = channel->senders.tail = NULL;
+    channel->receivers.head = channel->receivers.tail = NULL;
+    return channel;
+}
+
+static void grayWaiters(ChannelQueue *queue, MVM *vm) {
+    for (ChannelWaiter *waiter = queue->head; waiter != NULL; waiter = waiter->next) {
+        MSCGrayObject((Object *) waiter->djuru, vm);
+        MSCGrayValue(vm, waiter->value);
+    }
+}
+
+void MSCBlackenChannel(Channel *channel, MVM *vm) {
+    for (uint32_t i = 0; i < channel->count; i++) {
+        MSCGrayValue(vm, channel->buffer[(channel->head + i) % channel->capacity]);
+    }
+    // The parked djurus only wake up through the channel.
+    grayWaiters(&channel->senders, vm);
+    grayWaiters(&channel->receivers, vm);
+
+    vm->gc->bytesAllocated += sizeof(Channel);
+    vm->gc->bytesAllocated += sizeof(Value) * channel->capacity;
+}
+
+void MSCChannelEnqueue(ChannelQueue *queue, ChannelWaiter *waiter) {
+    waiter->queue = queue;
+    waiter->prev = queue->tail;
+    waiter->next = NULL;
+    if (queue->tail == NULL) {
+        queue->head = waiter;
+    } else {
+        queue->tail->next = waiter;
+    }
+    queue->tail = waiter;
+}
+
+void MSCChannelUnlink(ChannelWaiter *waiter) {
+    ChannelQueue *queue = waiter->queue;
+    if (waiter->prev == NULL) {
+        queue->head = waiter->next;
+    } else {
+        waiter->prev->next = waiter->next;
+    }
+    if (waiter->next == NULL) {
+        queue->tail = waiter->prev;
+    } else {
+        waiter->next->prev = waiter->prev;
+    }
+    waiter->prev = waiter->next = NULL;
+}
+
+Generator *MSCGeneratorFrom(MVM *vm, Closure *closure, Value *slots, int numSlots) {
+    // The frame holds at most its arguments and the slots its body uses.
+    int capacity = closure->fn->arity + 1 + closure->fn->maxSlots;
+    Generator *generator = ALLOCATE_FLEX(vm, Generator, Value, capacity);
+    initObj(vm, &generator->obj, OBJ_GENERATOR, vm->core.generatorClass);
+    generator->closure = closure;
+    generator->ip = closure->fn->code.data;
+    generator->state = GENERATOR_SUSPENDED;
+    generator->value = NULL_VAL;
+    generator->numSlots = numSlots;
+    generator->capacity = capacity;
+    memcpy(generator->slots, slots, sizeof(Value) * numSlots);
+    return generator;
+}
+
+void MSCBlackenGenerator(Generator *generator, MVM *vm) {
+    MSCGrayObject((Object *) generator->closure, vm);
+    MSCGrayValue(vm, generator->value);
+    for (int i = 0; i < generator->numSlots; i++) {
+        MSCGrayValue(vm, generator->slots[i]);
+    }
+
+    vm->gc->bytesAllocated += sizeof(Generator);
+    vm->gc->bytesAllocated += sizeof(Value) * generator->capacity;
+}
+
+// Frees the waiters of [queue]. The waiters of a select on other channels stay
+// where they are, but leave its ring, since those channels may be freed first.
+static void freeWaiters(ChannelQueue *queue, MVM *vm) {
+    ChannelWaiter *waiter = queue->head;
+    while (waiter != NULL) {
+        ChannelWaiter *next = waiter->next;
+        ChannelWaiter *previous = waiter;
+        while (previous->nextInSelect != waiter) previous = previous->nextInSelect;
+        previous->nextInSelect = waiter->nextInSelect;
+        DEALLOCATE(vm, waiter);
+        waiter = next;
+    }
+    queue->head = queue->tail = NULL;
+}
+
+void MSCFreeChannel(Channel *channel, MVM *vm) {
+    freeWaiters(&channel->senders, vm);
+    freeWaiters(&channel->receivers, vm);
+    DEALLOCATE(vm, channel->buffer);
+}
+
 
 void MSCBlackenModule(Module *module, MVM *vm) {
     // Object::blacken(vm);
@@ -940,37 +1676,24 @@ void MSCBlackenString(String *string, MVM *vm) {
 }
 
 
-Value MSCStringFromNum(MVM *vm, double value) {
+int MSCNumToChars(double value, char buffer[MSC_NUM_CHARS]) {
     // Edge case: If the value is NaN or infinity, different versions of libc
     // produce different outputs (some will format it signed and some won't). To
     // get reliable output, handle it ourselves.
-    if (isnan(value)) return CONST_STRING(vm, "nan");
+    if (isnan(value)) return sprintf(buffer, "nan");
     if (isinf(value)) {
         if (value > 0.0) {
-            return CONST_STRING(vm, "infinity");
+            return sprintf(buffer, "infinity");
         } else {
-            return CONST_STRING(vm, "-infinity");
+            return sprintf(buffer, "-infinity");
         }
     }
+    return MSCDoubleToChars(value, buffer);
+}
 
-    // This is large enough to hold any double converted to a string using
-    // "%.14g". Example:
-    //
-    //     -1.12345678901234e-1022
-    //
-    // So we have:
-    //
-    // + 1 char for sign
-    // + 1 char for digit
-    // + 1 char for "."
-    // + 14 chars for decimal digits
-    // + 1 char for "e"
-    // + 1 char for "-" or "+"
-    // + 4 chars for exponent
-    // + 1 char for "\0"
-    // = 24
-    char buffer[24];
-    int length = sprintf(buffer, "%.14g", value);
+Value MSCStringFromNum(MVM *vm, double value) {
+    char buffer[MSC_NUM_CHARS];
+    int length = MSCNumToChars(value, buffer);
     return MSCStringFromCharsWithLength(vm, buffer, (uint32_t) length);
 }
 
@@ -992,6 +1715,61 @@ Value MSCStringFromByte(MVM *vm, uint8_t value) {
     return OBJ_VAL(string);
 }
 
+Value MSCStringJoin(MVM *vm, const Value *parts, int count) {
+    uint32_t length = 0;
+    for (int i = 0; i < count; i++) {
+        length += AS_STRING(parts[i])->length;
+    }
+
+    String *string = MSCStringAllocate(vm, length);
+    char *to = string->value;
+    for (int i = 0; i < count; i++) {
+        String *part = AS_STRING(parts[i]);
+        memcpy(to, part->value, part->length);
+        to += part->length;
+    }
+    hashString(string);
+    return OBJ_VAL(string);
+}
+
+Value MSCListJoin(List *list, MVM *vm, String *separator) {
+    Value *elements = list->elements.data;
+    int count = list->elements.count;
+    char buffer[MSC_NUM_CHARS];
+
+    uint32_t length = count > 0 ? (uint32_t) (count - 1) * separator->length : 0;
+    for (int i = 0; i < count; i++) {
+        if (IS_STRING(elements[i])) {
+            length += AS_STRING(elements[i])->length;
+        } else if (IS_NUM(elements[i])) {
+            length += MSCNumToChars(AS_NUM(elements[i]), buffer);
+        } else {
+            return NULL_VAL;
+        }
+    }
+
+    String *string = MSCStringAllocate(vm, length);
+    char *to = string->value;
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            memcpy(to, separator->value, separator->length);
+            to += separator->length;
+        }
+        if (IS_STRING(elements[i])) {
+            String *element = AS_STRING(elements[i]);
+            memcpy(to, element->value, element->length);
+            to += element->length;
+        } else {
+            // Format into the buffer first, sprintf writes a trailing '\0'.
+            int numLength = MSCNumToChars(AS_NUM(elements[i]), buffer);
+            memcpy(to, buffer, numLength);
+            to += numLength;
+        }
+    }
+    hashString(string);
+    return OBJ_VAL(string);
+}
+
 Value MSCStringFormatted(MVM *vm, const char *format, ...) {
     va_list argList;
 
@@ -1163,6 +1941,7 @@ Function *MSCFunctionFrom(MVM *vm, Module *module, int maxSlots) {
     initObj(vm, &fn->obj, OBJ_FN, vm->core.fnClass);
     MSCInitValueBuffer(&fn->constants);
     MSCInitByteBuffer(&fn->code);
+    MSCInitHandlerBuffer(&fn->handlers);
     fn->module = module;
     fn->boundToClass = NULL;
     fn->maxSlots = maxSlots;
@@ -1184,6 +1963,7 @@ void MSCBlackenFunction(Function *function, MVM *vm) {
 
     // The debug line number buffer.
     vm->gc->bytesAllocated += sizeof(int) * function->code.capacity;
+    vm->gc->bytesAllocated += sizeof(Handler) * function->handlers.capacity;
 }
 
 
@@ -26,7 +26,13 @@
 #define AS_MODULE(value)      ((Module*)AS_OBJ(value))           // ObjModule*
 #define AS_NUM(value)         (MSCValueToNum(value))                // double
 #define AS_RANGE(v)         ((Range*)AS_OBJ(v))              // Range*
+#define AS_SET(v)             ((Set*)AS_OBJ(v))                  // Set*
+#define AS_DEQUE(v)           ((Deque*)AS_OBJ(v))                // Deque*
+#define AS_HEAP(v)            ((Heap*)AS_OBJ(v))                 // Heap*
+#define AS_CHANNEL(v)         ((Channel*)AS_OBJ(v))              // Channel*
+#define AS_GENERATOR(v)       ((Generator*)AS_OBJ(v))            // Generator*
 #define AS_STRING(v)          ((String*)AS_OBJ(v))               // String*
+#define AS_TYPED_ARRAY(v)     ((TypedArray*)AS_OBJ(v))           // TypedArray*
 #define AS_CSTRING(v)         (AS_STRING(v)->value)              // const char*
 
 #define BOOL_VAL(boolean) ((boolean) ? TRUE_VAL : FALSE_VAL)     // boolean
@@ -46,7 +52,13 @@
 #define IS_MAP(value) (MSCIsObjType(value, OBJ_MAP))           // Map
 #define IS_MODULE(value) (MSCIsObjType(value, OBJ_MODULE))     // Module
 #define IS_RANGE(value) (MSCIsObjType(value, OBJ_RANGE))       // Range
+#define IS_SET(value) (MSCIsObjType(value, OBJ_SET))           // Set
+#define IS_DEQUE(value) (MSCIsObjType(value, OBJ_DEQUE))       // Deque
+#define IS_HEAP(value) (MSCIsObjType(value, OBJ_HEAP))         // Heap
+#define IS_CHANNEL(value) (MSCIsObjType(value, OBJ_CHANNEL))   // Channel
+#define IS_GENERATOR(value) (MSCIsObjType(value, OBJ_GENERATOR)) // Generator
 #define IS_STRING(value) (MSCIsObjType(value, OBJ_STRING))     // String
+#define IS_TYPED_ARRAY(value) (MSCIsObjType(value, OBJ_TYPED_ARRAY)) // TypedArray
 
 // Creates a new string object from [text], which should be a bare C string
 // literal. This determines the length of the string automatically at compile
@@ -71,7 +83,13 @@ typedef enum {
     OBJ_MODULE,
     OBJ_STRING,
     OBJ_UPVALUE,
-    OBJ_RANGE
+    OBJ_RANGE,
+    OBJ_SET,
+    OBJ_TYPED_ARRAY,
+    OBJ_DEQUE,
+    OBJ_HEAP,
+    OBJ_CHANNEL,
+    OBJ_GENERATOR
 } ObjType;
 
 typedef struct sObject Object;
@@ -151,12 +169,38 @@ uint32_t MSCStringFind(String *string, String *needle, uint32_t code);
 Value MSCStringFromConstChars(MVM *vm, const char *cstr);
 
 
+// This is large enough to hold any double converted to a string by
+// MSCDoubleToChars(). The longest are small numbers written without an
+// exponent, like:
+//
+//     -0.0000012345678901234567
+//
+// So we have:
+//
+// + 1 char for sign
+// + 1 char for "0"
+// + 1 char for "."
+// + 5 chars for leading zeros
+// + 17 chars for significant digits
+// + 1 char for "\0"
+// = 26
+//
+// Rounded up to 32.
+#define MSC_NUM_CHARS 32
+
+// Writes [value] the way Diat's sebenma does into [buffer] and returns the
+// number of chars written.
+int MSCNumToChars(double value, char buffer[MSC_NUM_CHARS]);
+
 Value MSCStringFromNum(MVM *vm, double value);
 
 Value MSCStringFromCodePoint(MVM *vm, int point);
 
 Value MSCStringFromByte(MVM *vm, uint8_t byte);
 
+// Concatenates the [count] strings in [parts] with a single allocation.
+Value MSCStringJoin(MVM *vm, const Value *parts, int count);
+
 Value MSCStringFormatted(MVM *vm, const char *format, ...);
 
 String *MSCStringNew(MVM *vm, const char *text, uint32_t length);
@@ -195,6 +239,19 @@ typedef struct {
     IntBuffer sourceLines;
 } FnDebug;
 
+// A guarded region of a function's bytecode, registered by the compiler for an
+// `ake` block. An error raised while a frame of the function has its ip in
+// (start, end] resumes that frame at [target], with the stack cut back to
+// [depth] slots and the error pushed on top.
+typedef struct {
+    int start;
+    int end;
+    int target;
+    int depth;
+} Handler;
+
+DECLARE_BUFFER(Handler, Handler);
+
 typedef struct {
     Object obj;
     // The maximum number of stack slots this function may use.
@@ -210,6 +267,9 @@ typedef struct {
 
     ByteBuffer code;
     ValueBuffer constants;
+    // The guarded regions, innermost first. Empty for most functions, and
+    // only read when an error is raised.
+    HandlerBuffer handlers;
 } Function;
 
 Function *MSCFunctionFrom(MVM *vm, Module *module, int maxSlots);
@@ -366,29 +426,62 @@ Value MSCListRemoveAt(List *list, MVM *vm, uint32_t index);
 
 int MSCListIndexOf(List *list, MVM *vm, Value value);
 
+// Joins the elements of [list], separated by [separator], with a single
+// allocation. Returns NULL_VAL if an element is neither a string nor a number.
+Value MSCListJoin(List *list, MVM *vm, String *separator);
+
 void MSCBlackenList(List *list, MVM *vm);
 
 List *MSCListFrom(MVM *vm, int numElements);
 
 /** End of List related functions **/
 typedef struct {
-    // The entry's key, or UNDEFINED_VAL if the entry is not in use.
+    // The entry's key, or UNDEFINED_VAL if the entry has been removed.
     Value key;
 
-    // The value associated with the key. If the key is UNDEFINED_VAL, this will
-    // be false to indicate an open available entry or true to indicate a
-    // tombstone -- an entry that was previously in use but was then deleted.
+    // The value associated with the key.
     Value value;
 } MapEntry;
 
+// Control byte of an index slot that has never been used.
+#define MAP_CTRL_EMPTY ((uint8_t) 0x80)
+// Control byte of an index slot whose entry has been removed.
+#define MAP_CTRL_DELETED ((uint8_t) 0xfe)
+
+// The hash index shared by maps and sets. Both keep their entries densely
+// packed in insertion order, and find them through this separate, much
+// smaller index.
+typedef struct {
+    // Number of slots. Always zero or a power of two.
+    uint32_t capacity;
+    // Number of tombstones.
+    uint32_t deleted;
+
+    // One control byte per slot, followed by a mirror of the first group so
+    // that a group can be loaded at any slot without wrapping, followed by
+    // the position in the entries of each slot. A live slot stores the low 7
+    // bits of its key's hash, otherwise it is MAP_CTRL_EMPTY or
+    // MAP_CTRL_DELETED. Positions are 1, 2 or 4 bytes wide depending on
+    // [capacity].
+    uint8_t *ctrl;
+} HashIndex;
+
 typedef struct {
     Object obj;
 
+    // Number of entries allocated in [entries].
     uint32_t capacity;
+    // Number of live entries.
     uint32_t count;
+    // Number of entries in use, including the ones left behind as holes by
+    // removals. Iterating [entries] up to [used] visits keys in insertion
+    // order; holes have an undefined key.
+    uint32_t used;
 
     MapEntry *entries;
 
+    HashIndex index;
+
 } Map;
 
 Map *MSCMapFrom(MVM *vm);
@@ -410,6 +503,158 @@ Value MSCMapRemove(Map *map, MVM *vm, Value key);
 
 /** End of Map related functions **/
 
+// A set is laid out like a map, but stores keys only.
+typedef struct {
+    Object obj;
+
+    // Number of keys allocated in [keys].
+    uint32_t capacity;
+    // Number of live keys.
+    uint32_t count;
+    // Number of keys in use, including the holes left by removals, which are
+    // undefined.
+    uint32_t used;
+
+    Value *keys;
+
+    HashIndex index;
+
+} Set;
+
+Set *MSCSetFrom(MVM *vm);
+
+void MSCBlackenSet(Set *set, MVM *vm);
+
+bool MSCSetContains(Set *set, Value key);
+
+// Adds [key] to [set]. Returns `false` if it was already there.
+bool MSCSetAdd(Set *set, MVM *vm, Value key);
+
+// Removes [key] from [set]. Returns `false` if it was not there.
+bool MSCSetRemove(Set *set, MVM *vm, Value key);
+
+void MSCSetClear(Set *set, MVM *vm);
+
+/** End of Set related functions **/
+
+typedef enum {
+    TYPED_FLOAT64,
+    TYPED_INT32,
+    TYPED_UINT8
+} TypedArrayKind;
+
+// A fixed-size array of unboxed numbers stored contiguously.
+typedef struct {
+    Object obj;
+
+    TypedArrayKind kind;
+
+    // Number of elements in [data].
+    uint32_t count;
+
+    void *data;
+
+    // The array whose storage [data] points into when this array is a slice
+    // view, or NULL if this array owns [data].
+    Object *owner;
+
+} TypedArray;
+
+// Creates a zero-filled typed array of [count] elements.
+TypedArray *MSCTypedArrayFrom(MVM *vm, TypedArrayKind kind, uint32_t count);
+
+// Creates a view of [count] elements of [source] starting at [start]. The view
+// shares storage with [source], so writes through either are visible in both.
+TypedArray *MSCTypedArrayView(MVM *vm, TypedArray *source, uint32_t start, uint32_t count);
+
+void MSCBlackenTypedArray(TypedArray *array, MVM *vm);
+
+size_t MSCTypedArrayElementSize(TypedArrayKind kind);
+
+double MSCTypedArrayGet(const TypedArray *array, uint32_t index);
+
+// Converts [value] to an integer modulo 2^32, the way the integer kinds store
+// numbers that do not fit. NaN and infinities become 0.
+uint32_t MSCNumToUint32(double value);
+
+// Stores [value] at [index], truncating and wrapping it into the element type
+// for the integer kinds.
+void MSCTypedArraySet(TypedArray *array, uint32_t index, double value);
+
+/** End of TypedArray related functions **/
+
+// A double-ended queue stored in a ring buffer. The capacity is zero or a power
+// of two, so positions wrap around with a mask.
+typedef struct {
+    Object obj;
+
+    // Number of elements allocated in [data].
+    uint32_t capacity;
+    // Position in [data] of the first element.
+    uint32_t head;
+    // Number of elements.
+    uint32_t count;
+
+    Value *data;
+
+} Deque;
+
+Deque *MSCDequeFrom(MVM *vm);
+
+void MSCBlackenDeque(Deque *deque, MVM *vm);
+
+// Returns a pointer to the element at [index], counting from the front.
+static inline Value *MSCDequeAt(const Deque *deque, uint32_t index) {
+    return &deque->data[(deque->head + index) & (deque->capacity - 1)];
+}
+
+void MSCDequePushBack(Deque *deque, MVM *vm, Value value);
+
+void MSCDequePushFront(Deque *deque, MVM *vm, Value value);
+
+// Removes and returns the last element. [deque] must not be empty.
+Value MSCDequePopBack(Deque *deque, MVM *vm);
+
+// Removes and returns the first element. [deque] must not be empty.
+Value MSCDequePopFront(Deque *deque, MVM *vm);
+
+void MSCDequeClear(Deque *deque, MVM *vm);
+
+/** End of Deque related functions **/
+
+// How the entries of a heap are ordered.
+typedef enum {
+    // No comparer, and no entry yet.
+    HEAP_ORDER_ANY,
+    // In C, because every priority is a number, or every one a string.
+    HEAP_ORDER_NUMBERS,
+    HEAP_ORDER_STRINGS,
+    // By the script, with the comparer or `<`.
+    HEAP_ORDER_SCRIPT
+} HeapOrder;
+
+// A binary min-heap of values, each with a priority.
+typedef struct {
+    Object obj;
+
+    // The entries in heap order: the priority of entry i is at [2 * i] and its
+    // value at [2 * i + 1].
+    ValueBuffer entries;
+
+    // The function telling whether a priority comes before another, or null
+    // to use `<`.
+    Value comparer;
+
+    HeapOrder order;
+
+} Heap;
+
+Heap *MSCHeapFrom(MVM *vm, Value comparer);
+
+void MSCBlackenHeap(Heap *heap, MVM *vm);
+
+/** End of Heap related functions **/
+
 typedef struct {
     uint8_t *ip;
     Closure *closure;
@@ -446,6 +691,18 @@ typedef struct sDjuru {
 
     struct sDjuru *caller;
 
+    // The djurus waiting for this one to finish, linked through their
+    // [nextWaiter].
+    struct sDjuru *waiters;
+    struct sDjuru *nextWaiter;
+
+    // Whether the djuru is in the ready queue or sleeping in the scheduler.
+    bool scheduled;
+    // Whether the djuru was suspended at a loop or a call when the fuel ran
+    // out, rather than in a call that returns a value once it resumes.
+    bool preempted;
+    // Whether the djuru is a [SmallDjuru].
+    bool small;
 
 } Djuru;
 
@@ -461,6 +718,99 @@ bool MSCHasError(Djuru *djuru);
 
 /** End of Djuru related functions **/
 
+typedef struct sChannelWaiter ChannelWaiter;
+
+// The djurus parked on one side of a channel, in the order they came.
+typedef struct {
+    ChannelWaiter *head;
+    ChannelWaiter *tail;
+} ChannelQueue;
+
+// A djuru parked on a channel until it can send or receive.
+struct sChannelWaiter {
+    Djuru *djuru;
+    // The value a sender sends.
+    Value value;
+    // The side of the channel it is parked on.
+    ChannelQueue *queue;
+
+    // For a djuru waiting on several channels at once, the position of the
+    // channel in the ones it waits on, and the waiter on the next one, in a
+    // ring. Otherwise -1 and the waiter itself.
+    int index;
+    ChannelWaiter *nextInSelect;
+
+    ChannelWaiter *prev;
+    ChannelWaiter *next;
+};
+
+// A bounded queue of values passed between djurus. The buffered values are
+// kept in a ring of [capacity] slots. A djuru sending to a full channel, or
+// receiving from an empty one, is parked on it until another one receives or
+// sends.
+typedef struct {
+    Object obj;
+
+    uint32_t capacity;
+    // Position in [buffer] of the first value.
+    uint32_t head;
+    uint32_t count;
+    Value *buffer;
+
+    bool closed;
+
+    ChannelQueue senders;
+    ChannelQueue receivers;
+
+} Channel;
+
+Channel *MSCChannelFrom(MVM *vm, uint32_t capacity);
+
+void MSCBlackenChannel(Channel *channel, MVM *vm);
+
+void MSCFreeChannel(Channel *channel, MVM *vm);
+
+// Adds [waiter] to the end of [queue].
+void MSCChannelEnqueue(ChannelQueue *queue, ChannelWaiter *waiter);
+
+// Removes [waiter] from the queue it is in.
+void MSCChannelUnlink(ChannelWaiter *waiter);
+
+/** End of Channel related functions **/
+
+typedef enum {
+    GENERATOR_SUSPENDED,
+    GENERATOR_RUNNING,
+    GENERATOR_DONE,
+} GeneratorState;
+
+// The frame of a `tii*` function between two values. It runs on top of the
+// djuru that resumes it, and only its own slots are kept here while it is
+// suspended, so `labo` can only be used in the function's own body.
+typedef struct {
+    Object obj;
+
+    Closure *closure;
+    // Where the function continues when it is resumed.
+    uint8_t *ip;
+    GeneratorState state;
+    // The last value it produced.
+    Value value;
+
+    // The slots of the suspended frame, from the receiver up.
+    int numSlots;
+    int capacity;
+    Value slots[FLEXIBLE_ARRAY];
+} Generator;
+
+// Creates a generator for the frame of [closure] whose first [numSlots] slots
+// are [slots].
+Generator *MSCGeneratorFrom(MVM *vm, Closure *closure, Value *slots, int numSlots);
+
+void MSCBlackenGenerator(Generator *generator, MVM *vm);
+
+/** End of Generator related functions **/
+
 // An IEEE 754 double-precision float is a 64-bit value with bits laid out like:
 //
 // 1 Sign bit
@@ -0,0 +1,382 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "Gafe.h"
+
+#if MSC_OPT_GAFE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../runtime/MVM.h"
+
+#include "Gafe.msc.inc"
+
+// Reads and writes run on the I/O threads of the scheduler while the djuru
+// that started them is suspended. The threads only use the C heap, never the
+// VM's.
+
+typedef struct {
+    int fd;
+    // Whether an operation on the file is running. Only one may run at a time,
+    // since they share the file's position.
+    bool busy;
+} File;
+
+typedef struct {
+    AsyncOp op;
+    File *file;
+    // The bytes to read into or write from, and how many.
+    uint8_t *data;
+    size_t length;
+    // What the work did: a number of bytes, or the errno it failed with.
+    size_t count;
+    int error;
+    // Whether [data] is a mapping to unmap or a block to free once done.
+    bool mapped;
+    bool ownsData;
+    // The path of a file to read whole.
+    char *path;
+} FileOp;
+
+static bool beginOp(MVM *vm, File *file) {
+    if (file->fd == -1) {
+        vm->apiStack[0] = CONST_STRING(vm, "File is closed.");
+        MSCAbortDjuru(vm, 0);
+        return false;
+    }
+    if (file->busy) {
+        vm->apiStack[0] = CONST_STRING(vm, "File is busy with another operation.");
+        MSCAbortDjuru(vm, 0);
+        return false;
+    }
+    return true;
+}
+
+static Value errorValue(MVM *vm, FileOp *op, bool *isError) {
+    *isError = true;
+    return MSCStringFormatted(vm, "$", strerror(op->error));
+}
+
+static void fileOpRelease(MVM *vm, AsyncOp *op) {
+    FileOp *fileOp = (FileOp *) op;
+    (void) vm;
+    if (fileOp->mapped) {
+        munmap(fileOp->data, fileOp->length);
+    } else if (fileOp->ownsData) {
+        free(fileOp->data);
+    }
+    free(fileOp->path);
+}
+
+static void fileAllocate(MVM *vm) {
+    File *file = (File *) MSCSetSlotNewExtern(vm, 0, 0, sizeof(File));
+    file->fd = -1;
+    file->busy = false;
+
+    const char *path = MSCGetSlotString(vm, 1);
+    int flags;
+    switch ((int) MSCGetSlotDouble(vm, 2)) {
+        case 0:
+            flags = O_RDONLY;
+            break;
+        case 1:
+            flags = O_WRONLY | O_CREAT | O_TRUNC;
+            break;
+        default:
+            flags = O_WRONLY | O_CREAT | O_APPEND;
+            break;
+    }
+
+    do {
+        file->fd = open(path, flags, 0666);
+    } while (file->fd == -1 && errno == EINTR);
+
+    if (file->fd == -1) {
+        vm->apiStack[0] = MSCStringFormatted(vm, "Could not open '$': $", path,
+                                             strerror(errno));
+        MSCAbortDjuru(vm, 0);
+    }
+}
+
+static void fileFinalize(void *data) {
+    File *file = (File *) data;
+    if (file->fd != -1) close(file->fd);
+}
+
+static void fileClose(MVM *vm) {
+    File *file = (File *) MSCGetSlotExtern(vm, 0);
+    if (file->busy) {
+        vm->apiStack[0] = CONST_STRING(vm, "File is busy with another operation.");
+        MSCAbortDjuru(vm, 0);
+        return;
+    }
+    if (file->fd != -1) close(file->fd);
+    file->fd = -1;
+}
+
+static void fileSize(MVM *vm) {
+    File *file = (File *) MSCGetSlotExtern(vm, 0);
+    struct stat info;
+    if (file->fd == -1 || fstat(file->fd, &info) != 0) {
+        vm->apiStack[0] = CONST_STRING(vm, "Could not get the size of the file.");
+        MSCAbortDjuru(vm, 0);
+        return;
+    }
+    MSCSetSlotDouble(vm, 0, (double) info.st_size);
+}
+
+// Reading a whole file.
+
+static void readPathWork(AsyncOp *op) {
+    FileOp *fileOp = (FileOp *) op;
+    int fd;
+    do {
+        fd = open(fileOp->path, O_RDONLY);
+    } while (fd == -1 && errno == EINTR);
+    if (fd == -1) {
+        fileOp->error = errno;
+        return;
+    }
+
+    // Map the file instead of reading it through a growing buffer. The
+    // mapping stays valid once the file is closed.
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        fileOp->error = errno;
+    } else if ((uint64_t) info.st_size > UINT32_MAX) {
+        fileOp->error = EFBIG;
+    } else if (info.st_size > 0) {
+        void *data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            fileOp->error = errno;
+        } else {
+            fileOp->data = (uint8_t *) data;
+            fileOp->length = (size_t) info.st_size;
+            fileOp->mapped = true;
+        }
+    }
+    close(fd);
+}
+
+static Value readPathDone(MVM *vm, AsyncOp *op, bool *isError) {
+    FileOp *fileOp = (FileOp *) op;
+    if (fileOp->error != 0) {
+        *isError = true;
+        return MSCStringFormatted(vm, "Could not read '$': $", fileOp->path,
+                                  strerror(fileOp->error));
+    }
+    return MSCStringFromCharsWithLength(vm, (const char *) fileOp->data,
+                                        (uint32_t) fileOp->length);
+}
+
+static void fileReadPath(MVM *vm) {
+    const char *path = MSCGetSlotString(vm, 1);
+    FileOp *op = (FileOp *) MSCNewAsyncOp(vm, sizeof(FileOp), readPathWork,
+                                          readPathDone, fileOpRelease);
+    size_t length = strlen(path);
+    op->path = (char *) malloc(length + 1);
+    if (op->path == NULL) {
+        DEALLOCATE(vm, op);
+        vm->apiStack[0] = CONST_STRING(vm, "Out of memory.");
+        MSCAbortDjuru(vm, 0);
+        return;
+    }
+    memcpy(op->path, path, length + 1);
+    MSCScheduleAsync(vm, &op->op);
+}
+
+// Deleting a file. Like opening one, it is quick enough not to leave the
+// djuru's thread.
+
+static void fileDelete(MVM *vm) {
+    const char *path = MSCGetSlotString(vm, 1);
+    if (unlink(path) != 0) {
+        vm->apiStack[0] = MSCStringFormatted(vm, "Could not delete '$': $", path,
+                                             strerror(errno));
+        MSCAbortDjuru(vm, 0);
+    }
+}
+
+// Reading the rest of a file.
+
+static void readAllWork(AsyncOp *op) {
+    FileOp *fileOp = (FileOp *) op;
+    int fd = fileOp->file->fd;
+
+    // Start with what is left of the file, and grow if it grew.
+    struct stat info;
+    off_t position = lseek(fd, 0, SEEK_CUR);
+    size_t capacity = 4096;
+    if (fstat(fd, &info) == 0 && position >= 0 && info.st_size > position) {
+        capacity = (size_t) (info.st_size - position) + 1;
+    }
+
+    fileOp->data = (uint8_t *) malloc(capacity);
+    fileOp->length = 0;
+    for (;;) {
+        if (fileOp->data == NULL) {
+            fileOp->error = ENOMEM;
+            return;
+        }
+        if (fileOp->length == capacity) {
+            capacity *= 2;
+            uint8_t *grown = (uint8_t *) realloc(fileOp->data, capacity);
+            if (grown == NULL) free(fileOp->data);
+            fileOp->data = grown;
+            continue;
+        }
+
+        ssize_t count = read(fd, fileOp->data + fileOp->length, capacity - fileOp->length);
+        if (count == 0) break;
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            fileOp->error = errno;
+            return;
+        }
+        fileOp->length += (size_t) count;
+    }
+
+    if (fileOp->length > UINT32_MAX) fileOp->error = EFBIG;
+}
+
+static Value readAllDone(MVM *vm, AsyncOp *op, bool *isError) {
+    FileOp *fileOp = (FileOp *) op;
+    fileOp->file->busy = false;
+    if (fileOp->error != 0) return errorValue(vm, fileOp, isError);
+    return MSCStringFromCharsWithLength(vm, (const char *) fileOp->data,
+                                        (uint32_t) fileOp->length);
+}
+
+static void fileReadAll(MVM *vm) {
+    File *file = (File *) MSCGetSlotExtern(vm, 0);
+    if (!beginOp(vm, file)) return;
+
+    FileOp *op = (FileOp *) MSCNewAsyncOp(vm, sizeof(FileOp), readAllWork,
+                                          readAllDone, fileOpRelease);
+    op->file = file;
+    op->ownsData = true;
+    file->busy = true;
+    MSCScheduleAsync(vm, &op->op);
+}
+
+// Reading into a buffer and writing.
+
+static void readWork(AsyncOp *op) {
+    FileOp *fileOp = (FileOp *) op;
+    ssize_t count;
+    do {
+        count = read(fileOp->file->fd, fileOp->data, fileOp->length);
+    } while (count < 0 && errno == EINTR);
+
+    if (count < 0) {
+        fileOp->error = errno;
+    } else {
+        fileOp->count = (size_t) count;
+    }
+}
+
+static void writeWork(AsyncOp *op) {
+    FileOp *fileOp = (FileOp *) op;
+    while (fileOp->count < fileOp->length) {
+        ssize_t count = write(fileOp->file->fd, fileOp->data + fileOp->count,
+                              fileOp->length - fileOp->count);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            fileOp->error = errno;
+            return;
+        }
+        fileOp->count += (size_t) count;
+    }
+}
+
+static Value countDone(MVM *vm, AsyncOp *op, bool *isError) {
+    FileOp *fileOp = (FileOp *) op;
+    fileOp->file->busy = false;
+    if (fileOp->error != 0) return errorValue(vm, fileOp, isError);
+    return NUM_VAL((double) fileOp->count);
+}
+
+static void fileRead(MVM *vm) {
+    File *file = (File *) MSCGetSlotExtern(vm, 0);
+    if (!beginOp(vm, file)) return;
+
+    size_t length;
+    uint8_t *data = MSCGetSlotBuffer(vm, 1, &length);
+    FileOp *op = (FileOp *) MSCNewAsyncOp(vm, sizeof(FileOp), readWork,
+                                          countDone, NULL);
+    op->op.keep = vm->apiStack[1];
+    op->file = file;
+    op->data = data;
+    op->length = length;
+    file->busy = true;
+    MSCScheduleAsync(vm, &op->op);
+}
+
+static void fileWrite(MVM *vm) {
+    File *file = (File *) MSCGetSlotExtern(vm, 0);
+    if (!beginOp(vm, file)) return;
+
+    uint8_t *data;
+    size_t length;
+    if (IS_STRING(vm->apiStack[1])) {
+        data = (uint8_t *) AS_STRING(vm->apiStack[1])->value;
+        length = AS_STRING(vm->apiStack[1])->length;
+    } else {
+        data = MSCGetSlotBuffer(vm, 1, &length);
+    }
+
+    FileOp *op = (FileOp *) MSCNewAsyncOp(vm, sizeof(FileOp), writeWork,
+                                          countDone, NULL);
+    op->op.keep = vm->apiStack[1];
+    op->file = file;
+    op->data = data;
+    op->length = length;
+    file->busy = true;
+    MSCScheduleAsync(vm, &op->op);
+}
+
+const char *MSCGafeSource() {
+    return GafeModuleSource;
+}
+
+MSCExternClassMethods MSCGafeBindExternClass(MVM *vm,
+                                             const char *module,
+                                             const char *className) {
+    ASSERT(strcmp(className, "Gafe") == 0, "Should be in Gafe class.");
+    MSCExternClassMethods methods;
+    methods.allocate = fileAllocate;
+    methods.finalize = fileFinalize;
+    return methods;
+}
+
+MSCExternMethodFn MSCGafeBindExternMethod(MVM *vm,
+                                          const char *className,
+                                          bool isStatic,
+                                          const char *signature) {
+    ASSERT(strcmp(className, "Gafe") == 0, "Should be in Gafe class.");
+
+    if (strcmp(signature, "<allocate>") == 0) return fileAllocate;
+    if (strcmp(signature, "datugu()") == 0) return fileClose;
+    if (strcmp(signature, "bonya") == 0) return fileSize;
+    if (strcmp(signature, "beeKalan_(_)") == 0) return fileReadPath;
+    if (strcmp(signature, "josi_(_)") == 0) return fileDelete;
+    if (strcmp(signature, "kalan_()") == 0) return fileReadAll;
+    if (strcmp(signature, "kalan_(_)") == 0) return fileRead;
+    if (strcmp(signature, "seben_(_)") == 0) return fileWrite;
+
+    ASSERT(false, "Unknown method.");
+    return NULL;
+}
+
+#endif
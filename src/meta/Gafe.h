@@ -0,0 +1,25 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#ifndef MOSC_GAFE_H
+#define MOSC_GAFE_H
+
+#include "../common/common.h"
+#include "../api/msc.h"
+
+// This module defines the Gafe class, files whose reads and writes suspend the
+// calling djuru until they are done.
+#if MSC_OPT_GAFE
+
+const char* MSCGafeSource();
+MSCExternClassMethods MSCGafeBindExternClass(MVM* vm,
+                                                  const char* module,
+                                                  const char* className);
+MSCExternMethodFn MSCGafeBindExternMethod(MVM* vm,
+                                               const char* className,
+                                               bool isStatic,
+                                               const char* signature);
+
+#endif
+#endif //MOSC_GAFE_H
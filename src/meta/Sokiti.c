@@ -0,0 +1,398 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "Sokiti.h"
+
+#if MSC_OPT_SOKITI
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "../runtime/MVM.h"
+
+#include "Sokiti.msc.inc"
+
+#if !MSC_OPT_POLL
+#error "The sokiti module needs MSC_OPT_POLL."
+#endif
+
+// Sockets are non-blocking. Each operation is tried right away, and if the
+// socket is not ready, parks the djuru on it and returns null, so that the
+// script suspends and tries again once it is woken up.
+
+// The most bytes [kalan()] returns at once.
+#define SOCKET_READ_SIZE 16384
+// The most parts of a list [seben(_)] writes in one call.
+#define SOCKET_WRITE_PARTS 64
+
+typedef struct {
+    // [wait.fd] is the socket, or -1 once it is closed.
+    PollWait wait;
+    // Whether the connection is being made, and whether the djuru making it
+    // already waited for it.
+    bool connecting;
+    bool connectWaited;
+} Socket;
+
+static void abortWith(MVM *vm, const char *message, int error) {
+    vm->apiStack[0] = MSCStringFormatted(vm, "$: $", message, strerror(error));
+    MSCAbortDjuru(vm, 0);
+}
+
+static void initSocket(Socket *socket) {
+    memset(socket, 0, sizeof(Socket));
+    socket->wait.fd = -1;
+}
+
+// Aborts and returns NULL if the socket in slot 0 is closed.
+static Socket *openSocket(MVM *vm) {
+    Socket *socket = (Socket *) MSCGetSlotExtern(vm, 0);
+    if (socket->wait.fd != -1) return socket;
+
+    vm->apiStack[0] = CONST_STRING(vm, "Socket is closed.");
+    MSCAbortDjuru(vm, 0);
+    return NULL;
+}
+
+// Parks the current djuru until [socket] can be read or written, and returns
+// null, which tells the script to suspend and try again.
+static void park(MVM *vm, Socket *socket, bool write) {
+    Djuru *waiting = write ? socket->wait.writer : socket->wait.reader;
+    if (waiting != NULL) {
+        vm->apiStack[0] = CONST_STRING(vm, "Another djuru is already waiting for the socket.");
+        MSCAbortDjuru(vm, 0);
+        return;
+    }
+    if (!MSCSchedulePoll(vm, &socket->wait, write)) {
+        abortWith(vm, "Could not wait for the socket", errno);
+        return;
+    }
+    MSCSetSlotNull(vm, 0);
+}
+
+// Resolves [host] and [port] in slots 1 and 2 and calls [use] on each address
+// until it returns a socket. Aborts with [message] and returns -1 if none does.
+static int eachAddress(MVM *vm, bool passive, const char *message,
+                       int (*use)(struct addrinfo *address, bool *connecting),
+                       bool *connecting) {
+    if (MSCGetSlotType(vm, 1) != MSC_TYPE_STRING) {
+        vm->apiStack[0] = CONST_STRING(vm, "Host must be a string.");
+        MSCAbortDjuru(vm, 0);
+        return -1;
+    }
+    if (MSCGetSlotType(vm, 2) != MSC_TYPE_NUM) {
+        vm->apiStack[0] = CONST_STRING(vm, "Port must be an integer.");
+        MSCAbortDjuru(vm, 0);
+        return -1;
+    }
+
+    const char *host = MSCGetSlotString(vm, 1);
+    char port[16];
+    snprintf(port, sizeof(port), "%d", (int) MSCGetSlotDouble(vm, 2));
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV | (passive ? AI_PASSIVE : 0);
+
+    // Resolving a name blocks. Numeric addresses and localhost do not wait.
+    struct addrinfo *addresses;
+    int status = getaddrinfo(host, port, &hints, &addresses);
+    if (status != 0) {
+        vm->apiStack[0] = MSCStringFormatted(vm, "$ '$': $", message, host,
+                                             gai_strerror(status));
+        MSCAbortDjuru(vm, 0);
+        return -1;
+    }
+
+    int fd = -1;
+    int error = 0;
+    for (struct addrinfo *address = addresses; address != NULL; address = address->ai_next) {
+        fd = use(address, connecting);
+        if (fd != -1) break;
+        error = errno;
+    }
+    freeaddrinfo(addresses);
+
+    if (fd == -1) {
+        vm->apiStack[0] = MSCStringFormatted(vm, "$ '$:$': $", message, host, port,
+                                             strerror(error));
+        MSCAbortDjuru(vm, 0);
+    }
+    return fd;
+}
+
+static int connectTo(struct addrinfo *address, bool *connecting) {
+    int fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                    address->ai_protocol);
+    if (fd == -1) return -1;
+
+    if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+        *connecting = false;
+        return fd;
+    }
+    if (errno == EINPROGRESS) {
+        *connecting = true;
+        return fd;
+    }
+
+    int error = errno;
+    close(fd);
+    errno = error;
+    return -1;
+}
+
+static int listenOn(struct addrinfo *address, bool *connecting) {
+    (void) connecting;
+    int fd = socket(address->ai_family, address->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                    address->ai_protocol);
+    if (fd == -1) return -1;
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(fd, address->ai_addr, address->ai_addrlen) == 0 &&
+        listen(fd, SOMAXCONN) == 0) {
+        return fd;
+    }
+
+    int error = errno;
+    close(fd);
+    errno = error;
+    return -1;
+}
+
+static void socketAllocate(MVM *vm) {
+    Socket *socket = (Socket *) MSCSetSlotNewExtern(vm, 0, 0, sizeof(Socket));
+    initSocket(socket);
+
+    bool connecting = false;
+    int fd = eachAddress(vm, false, "Could not connect to", connectTo, &connecting);
+    socket->wait.fd = fd;
+    socket->connecting = connecting;
+}
+
+static void listenerAllocate(MVM *vm) {
+    Socket *socket = (Socket *) MSCSetSlotNewExtern(vm, 0, 0, sizeof(Socket));
+    initSocket(socket);
+
+    bool connecting = false;
+    socket->wait.fd = eachAddress(vm, true, "Could not listen on", listenOn, &connecting);
+}
+
+static void socketFinalize(void *data) {
+    Socket *socket = (Socket *) data;
+    if (socket->wait.fd != -1) close(socket->wait.fd);
+}
+
+static void socketClose(MVM *vm) {
+    Socket *socket = (Socket *) MSCGetSlotExtern(vm, 0);
+    if (socket->wait.fd == -1) return;
+
+    // Wake the djurus waiting for it, which then find it closed.
+    MSCScheduleUnpoll(vm, &socket->wait);
+    close(socket->wait.fd);
+    socket->wait.fd = -1;
+}
+
+static void socketFinishConnect(MVM *vm) {
+    Socket *socket = openSocket(vm);
+    if (socket == NULL) return;
+
+    if (!socket->connecting) {
+        MSCSetSlotBool(vm, 0, true);
+        return;
+    }
+
+    // The socket becomes writable once the connection is made or failed.
+    if (!socket->connectWaited) {
+        socket->connectWaited = true;
+        park(vm, socket, true);
+        if (!MSCHasError(vm->djuru)) MSCSetSlotBool(vm, 0, false);
+        return;
+    }
+
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (getsockopt(socket->wait.fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0) {
+        error = errno;
+    }
+    socket->connecting = false;
+    if (error != 0) {
+        abortWith(vm, "Could not connect", error);
+        return;
+    }
+    MSCSetSlotBool(vm, 0, true);
+}
+
+// Returns the number of bytes [result] says were moved, or parks the djuru
+// for [write] and returns -1.
+static ssize_t checkTransfer(MVM *vm, Socket *socket, ssize_t result, bool write) {
+    if (result >= 0) return result;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        park(vm, socket, write);
+    } else {
+        abortWith(vm, write ? "Could not write to the socket" : "Could not read from the socket",
+                  errno);
+    }
+    return -1;
+}
+
+static void socketRead(MVM *vm) {
+    Socket *socket = openSocket(vm);
+    if (socket == NULL) return;
+
+    char data[SOCKET_READ_SIZE];
+    ssize_t count = checkTransfer(vm, socket, recv(socket->wait.fd, data, sizeof(data), 0), false);
+    if (count >= 0) MSCSetSlotBytes(vm, 0, data, (size_t) count);
+}
+
+static void socketReadInto(MVM *vm) {
+    Socket *socket = openSocket(vm);
+    if (socket == NULL) return;
+
+    // Read straight into the buffer's bytes.
+    size_t length;
+    uint8_t *data = MSCGetSlotBuffer(vm, 1, &length);
+    ssize_t count = checkTransfer(vm, socket, recv(socket->wait.fd, data, length, 0), false);
+    if (count >= 0) MSCSetSlotDouble(vm, 0, (double) count);
+}
+
+static void socketWrite(MVM *vm) {
+    Socket *socket = openSocket(vm);
+    if (socket == NULL) return;
+
+    // Gather the parts after the bytes already sent into one write.
+    List *parts = AS_LIST(vm->apiStack[1]);
+    size_t skip = (size_t) MSCGetSlotDouble(vm, 2);
+    struct iovec vectors[SOCKET_WRITE_PARTS];
+    int count = 0;
+    for (int i = 0; i < parts->elements.count && count < SOCKET_WRITE_PARTS; i++) {
+        Value part = parts->elements.data[i];
+        uint8_t *bytes;
+        size_t length;
+        if (IS_STRING(part)) {
+            bytes = (uint8_t *) AS_STRING(part)->value;
+            length = AS_STRING(part)->length;
+        } else if (IS_TYPED_ARRAY(part) && AS_TYPED_ARRAY(part)->kind == TYPED_UINT8) {
+            bytes = (uint8_t *) AS_TYPED_ARRAY(part)->data;
+            length = AS_TYPED_ARRAY(part)->count;
+        } else {
+            vm->apiStack[0] = CONST_STRING(vm, "Data must be a string, a Uint8Walan or a list of them.");
+            MSCAbortDjuru(vm, 0);
+            return;
+        }
+
+        if (skip >= length) {
+            skip -= length;
+            continue;
+        }
+        vectors[count].iov_base = bytes + skip;
+        vectors[count].iov_len = length - skip;
+        skip = 0;
+        count++;
+    }
+
+    if (count == 0) {
+        MSCSetSlotDouble(vm, 0, 0);
+        return;
+    }
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = vectors;
+    message.msg_iovlen = (size_t) count;
+    // Report a closed connection as an error instead of raising SIGPIPE.
+    ssize_t sent = checkTransfer(vm, socket, sendmsg(socket->wait.fd, &message, MSG_NOSIGNAL), true);
+    if (sent >= 0) MSCSetSlotDouble(vm, 0, (double) sent);
+}
+
+static void listenerAccept(MVM *vm) {
+    Socket *listener = openSocket(vm);
+    if (listener == NULL) return;
+
+    int fd = accept4(listener->wait.fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd == -1) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ||
+            errno == ECONNABORTED) {
+            park(vm, listener, false);
+        } else {
+            abortWith(vm, "Could not accept a connection", errno);
+        }
+        return;
+    }
+
+    Socket *socket = (Socket *) MSCSetSlotNewExtern(vm, 0, 1, sizeof(Socket));
+    initSocket(socket);
+    socket->wait.fd = fd;
+}
+
+static void listenerPort(MVM *vm) {
+    Socket *listener = openSocket(vm);
+    if (listener == NULL) return;
+
+    struct sockaddr_storage address;
+    socklen_t length = sizeof(address);
+    if (getsockname(listener->wait.fd, (struct sockaddr *) &address, &length) != 0) {
+        abortWith(vm, "Could not get the port", errno);
+        return;
+    }
+
+    int port = 0;
+    if (address.ss_family == AF_INET) {
+        port = ntohs(((struct sockaddr_in *) &address)->sin_port);
+    } else if (address.ss_family == AF_INET6) {
+        port = ntohs(((struct sockaddr_in6 *) &address)->sin6_port);
+    }
+    MSCSetSlotDouble(vm, 0, port);
+}
+
+const char *MSCSokitiSource() {
+    return SokitiModuleSource;
+}
+
+MSCExternClassMethods MSCSokitiBindExternClass(MVM *vm,
+                                               const char *module,
+                                               const char *className) {
+    MSCExternClassMethods methods;
+    methods.allocate = strcmp(className, "Lamenna") == 0 ? listenerAllocate : socketAllocate;
+    methods.finalize = socketFinalize;
+    return methods;
+}
+
+MSCExternMethodFn MSCSokitiBindExternMethod(MVM *vm,
+                                            const char *className,
+                                            bool isStatic,
+                                            const char *signature) {
+    if (strcmp(className, "Lamenna") == 0) {
+        if (strcmp(signature, "<allocate>") == 0) return listenerAllocate;
+        if (strcmp(signature, "jaabi_(_)") == 0) return listenerAccept;
+        if (strcmp(signature, "port") == 0) return listenerPort;
+        if (strcmp(signature, "datugu()") == 0) return socketClose;
+    }
+
+    ASSERT(strcmp(className, "Sokiti") == 0, "Should be in Sokiti class.");
+
+    if (strcmp(signature, "<allocate>") == 0) return socketAllocate;
+    if (strcmp(signature, "siraLaban_()") == 0) return socketFinishConnect;
+    if (strcmp(signature, "kalan_()") == 0) return socketRead;
+    if (strcmp(signature, "kalan_(_)") == 0) return socketReadInto;
+    if (strcmp(signature, "seben_(_,_)") == 0) return socketWrite;
+    if (strcmp(signature, "datugu()") == 0) return socketClose;
+
+    ASSERT(false, "Unknown method.");
+    return NULL;
+}
+
+#endif
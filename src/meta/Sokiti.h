@@ -0,0 +1,25 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#ifndef MOSC_SOKITI_H
+#define MOSC_SOKITI_H
+
+#include "../common/common.h"
+#include "../api/msc.h"
+
+// This module defines the Sokiti and Lamenna classes, TCP sockets whose
+// operations park the calling djuru until the socket is ready.
+#if MSC_OPT_SOKITI
+
+const char* MSCSokitiSource();
+MSCExternClassMethods MSCSokitiBindExternClass(MVM* vm,
+                                                    const char* module,
+                                                    const char* className);
+MSCExternMethodFn MSCSokitiBindExternMethod(MVM* vm,
+                                                 const char* className,
+                                                 bool isStatic,
+                                                 const char* signature);
+
+#endif
+#endif //MOSC_SOKITI_H
@@ -6,6 +6,9 @@
 #include "MVM.h"
 #include "../builtin/Primitive.h"
 #include "debuger.h"
+#include "Workers.h"
+
+#include <math.h>
 
 #if MSC_OPT_FAN
 
@@ -17,6 +20,16 @@
 #include "../meta/Kunfe.h"
 #include "../memory/Value.h"
 
+#endif
+#if MSC_OPT_GAFE
+
+#include "../meta/Gafe.h"
+
+#endif
+#if MSC_OPT_SOKITI
+
+#include "../meta/Sokiti.h"
+
 #endif
 
 static void printFunctionCode(Function *fn) {
@@ -62,6 +75,16 @@ static MSCExternMethodFn findExternMethod(MVM *vm,
             method = MSCKunfeBindExternMethod(vm, className, isStatic, signature);
         }
 #endif
+#if MSC_OPT_GAFE
+        if (strcmp(moduleName, "gafe") == 0) {
+            method = MSCGafeBindExternMethod(vm, className, isStatic, signature);
+        }
+#endif
+#if MSC_OPT_SOKITI
+        if (strcmp(moduleName, "sokiti") == 0) {
+            method = MSCSokitiBindExternMethod(vm, className, isStatic, signature);
+        }
+#endif
 
     }
 
@@ -145,6 +168,45 @@ static void methodNotFound(MVM *vm, Class *classObj, int symbol) {
 }
 
 
+// Looks for an `ake` handler guarding the point where one of [djuru]'s frames
+// stopped, starting from the innermost frame. If one is found, drops the
+// frames above it, resumes the frame at the handler with [error] on top of
+// its stack, and returns true.
+static bool catchError(Djuru *djuru, Value error) {
+    for (int i = djuru->numOfFrames - 1; i >= 0; i--) {
+        CallFrame *frame = &djuru->frames[i];
+        Function *fn = frame->closure->fn;
+        if (fn->handlers.count == 0) continue;
+
+        int offset = (int) (frame->ip - fn->code.data);
+        for (int h = 0; h < fn->handlers.count; h++) {
+            Handler *handler = &fn->handlers.data[h];
+            if (offset <= handler->start || offset > handler->end) continue;
+
+            // A generator whose frame is dropped can't be resumed any more.
+            for (int j = djuru->numOfFrames - 1; j > i; j--) {
+                CallFrame *dropped = &djuru->frames[j];
+                if (dropped->closure->fn->code.data[0] != OP_GENERATOR) continue;
+
+                Generator *generator = AS_GENERATOR(dropped->stackStart[-1]);
+                generator->state = GENERATOR_DONE;
+                generator->value = NULL_VAL;
+                generator->numSlots = 0;
+            }
+
+            Value *top = frame->stackStart + handler->depth;
+            closeUpvalues(djuru, top);
+            djuru->numOfFrames = i + 1;
+            djuru->stackTop = top;
+            *djuru->stackTop++ = error;
+            djuru->error = NULL_VAL;
+            frame->ip = fn->code.data + handler->target;
+            return true;
+        }
+    }
+    return false;
+}
+
 // Handles the current fiber having aborted because of an error.
 //
 // Walks the call chain of fibers, aborting each one until it hits a fiber that
@@ -156,8 +218,15 @@ static void runtimeError(MVM *vm) {
     Value error = current->error;
 
     while (current != NULL) {
+        // An `ake` block in the fiber itself takes the error first.
+        if (catchError(current, error)) {
+            vm->djuru = current;
+            return;
+        }
+
         // Every fiber along the call chain gets aborted with the same error.
         current->error = error;
+        if (current->waiters != NULL) MSCWakeWaiters(vm, current, NULL_VAL);
 
         // If the caller ran vm fiber using "try", give it the error and stop.
         if (current->state == DJURU_TRY) {
@@ -234,6 +303,9 @@ void MSCInitConfig(MSCConfig *config) {
     config->initialHeapSize = 1024 * 1024 * 10;
     config->minHeapSize = 1024 * 1024;
     config->heapGrowthPercent = 50;
+    config->workerThreads = 0;
+    config->parallelThreshold = 65536;
+    config->fuelSuspends = false;
     config->userData = NULL;
 }
 
@@ -268,8 +340,12 @@ MVM *MSCNewVM(MSCConfig *config) {
 void MSCFreeVM(MVM *vm) {
     ASSERT(vm->methodNames.count > 0, "VM appears to have already been freed.");
 
+    MSCFreeWorkers(vm);
+    MSCFreeScheduler(vm);
+
     // Free all of the GC objects.
     MSCFreeGC(vm->gc);
+    MSCFreeDjuruPool(vm);
     MSCSymbolTableClear(vm, &vm->methodNames);
     // Tell the user if they didn't free any handles. We don't want to just free
     // them here because the host app may still have pointers to them that they
@@ -414,7 +490,15 @@ static Value validateSuperclass(MVM *vm, Value name, Value superclassValue, int
         superclass == vm->core.listClass ||
         superclass == vm->core.mapClass ||
         superclass == vm->core.rangeClass ||
+        superclass == vm->core.setClass ||
+        superclass == vm->core.dequeClass ||
+        superclass == vm->core.heapClass ||
+        superclass == vm->core.channelClass ||
+        superclass == vm->core.generatorClass ||
         superclass == vm->core.stringClass ||
+        superclass == vm->core.float64ArrayClass ||
+        superclass == vm->core.int32ArrayClass ||
+        superclass == vm->core.uint8ArrayClass ||
         superclass == vm->core.boolClass ||
         superclass == vm->core.nullClass ||
         superclass == vm->core.numClass) {
@@ -463,6 +547,18 @@ static void bindExternClass(MVM *vm, Class *classObj, Module *module) {
             methods = MSCKunfeBindExternClass(vm, module->name->value,
                                               classObj->name->value);
         }
+#endif
+#if MSC_OPT_GAFE
+        if (strcmp(module->name->value, "gafe") == 0) {
+            methods = MSCGafeBindExternClass(vm, module->name->value,
+                                             classObj->name->value);
+        }
+#endif
+#if MSC_OPT_SOKITI
+        if (strcmp(module->name->value, "sokiti") == 0) {
+            methods = MSCSokitiBindExternClass(vm, module->name->value,
+                                               classObj->name->value);
+        }
 #endif
     }
 
@@ -667,12 +763,50 @@ static void createExtern(MVM *vm, Djuru *djuru, Value *stack) {
     vm->apiStack = NULL;
 }
 
+// Steps [iterator] over the range [from] to [to] by [step], with the same rules
+// as range_iterate. Stores the next index in [index] and returns false once the
+// range is exhausted.
+static inline bool rangeNext(double from, double to, bool isInclusive, double step,
+                             Value iterator, double *index) {
+    if (from == to && !isInclusive) return false;
+
+    if (IS_NULL(iterator)) {
+        if (step >= 0) *index = from;
+        else if (isInclusive) *index = to;
+        else *index = to > from ? to - 1 : to + 1;
+        return true;
+    }
+
+    double next = AS_NUM(iterator);
+    if (from < to) {
+        next += step;
+        if ((step >= 0 && next > to) || (step < 0 && next < from)) return false;
+    } else {
+        next -= step;
+        if ((step >= 0 && next < to) || (step < 0 && next > from)) return false;
+    }
+    if (!isInclusive && next == to) return false;
+
+    *index = next;
+    return true;
+}
+
+// Returns true if [classObj] still steps with the iterate(_,_) and
+// iteratorValue(_) primitives bound by the core, rather than ones a script
+// replaced, so that a loop over it can skip calling them.
+static inline bool hasNativeIteration(const Class *classObj, int iterateSymbol, int valueSymbol) {
+    return iterateSymbol < classObj->methods.count && valueSymbol < classObj->methods.count &&
+           classObj->methods.data[iterateSymbol].type == METHOD_PRIMITIVE &&
+           classObj->methods.data[valueSymbol].type == METHOD_PRIMITIVE;
+}
+
 static Method *findExtensionMethod(MVM *vm, Class *classObj, int symbol) {
     if (classObj == NULL) {
         return NULL;
     }
-    Method *ret = &classObj->methods.data[symbol];
-    if (ret->type != METHOD_BLOCK) {
+    // The symbol may be past the end of the method table.
+    Method *ret = symbol < classObj->methods.count ? &classObj->methods.data[symbol] : NULL;
+    if (ret == NULL || ret->type != METHOD_BLOCK) {
         ret = findExtensionMethod(vm, classObj->superclass, symbol);
         if (ret != NULL && ret->type == METHOD_BLOCK) {
             // bind to the superclass for next call if needed
@@ -711,6 +845,12 @@ static Value importModule(MVM *vm, Value name) {
 #if MSC_OPT_KUNFE
         if (strcmp(nameString->value, "kunfe") == 0) result.source = MSCKunfeSource();
 #endif
+#if MSC_OPT_GAFE
+        if (strcmp(nameString->value, "gafe") == 0) result.source = MSCGafeSource();
+#endif
+#if MSC_OPT_SOKITI
+        if (strcmp(nameString->value, "sokiti") == 0) result.source = MSCSokitiSource();
+#endif
 
     }
 
@@ -739,13 +879,112 @@ static Value importModule(MVM *vm, Value name) {
 }
 
 
+// What the interpreter does once it has reached a safe point.
+typedef enum {
+    SAFE_POINT_GO_ON,
+    // The current djuru's error is set.
+    SAFE_POINT_ABORT,
+    // The fuel ran out and the djuru must be suspended.
+    SAFE_POINT_SUSPEND
+} SafePointAction;
+
+// Handles the [SafePoint] bits that made the interpreter stop at a loop
+// back-edge or a call. An interrupt or a deadline aborts once: the bit is
+// cleared with it. Running out of fuel stops every safe point until there is
+// fuel again.
+static SafePointAction reachSafePoint(MVM *vm) {
+    int bits = SAFE_POINT_LOAD(vm);
+    if (bits & SAFE_POINT_INTERRUPT) {
+        SAFE_POINT_CLEAR(vm, SAFE_POINT_INTERRUPT);
+        vm->djuru->error = CONST_STRING(vm, "Djuru was interrupted.");
+        return SAFE_POINT_ABORT;
+    }
+
+    // A passed deadline stays armed, and the clock is read at every later
+    // safe point, so that an 'ake' catching the error cannot keep running.
+    // Only the end of the call from the host disarms it.
+    if ((bits & SAFE_POINT_DEADLINE) && --vm->deadlinePolls <= 0) {
+        if (MSCMonotonicMillis() >= vm->deadline) {
+            vm->deadlinePolls = 0;
+            vm->djuru->error = CONST_STRING(vm, "Deadline exceeded.");
+            return SAFE_POINT_ABORT;
+        }
+        vm->deadlinePolls = DEADLINE_POLLS;
+    }
+
+    if (bits & SAFE_POINT_FUEL) {
+        if (vm->fuel <= 0) {
+            if (vm->config.fuelSuspends) return SAFE_POINT_SUSPEND;
+            vm->djuru->error = CONST_STRING(vm, "Out of fuel.");
+            return SAFE_POINT_ABORT;
+        }
+        vm->fuel--;
+    }
+    return SAFE_POINT_GO_ON;
+}
+
+// Suspends [djuru], whose frame is stored, in the scheduler until there is
+// fuel again. If another djuru called it, it still returns to that one.
+static void preempt(MVM *vm, Djuru *djuru) {
+    djuru->preempted = true;
+    MSCScheduleReady(vm, djuru, NULL_VAL);
+    vm->djuru = NULL;
+}
+
+// Starts the deadline of a call from the host if there is a timeout, keeping
+// the one of an enclosing call if it is sooner. Returns the deadline to
+// restore with [endDeadline] once the call returns.
+static double startDeadline(MVM *vm) {
+    double enclosing = vm->deadline;
+    if (vm->timeout <= 0) return enclosing;
+
+    double deadline = MSCMonotonicMillis() + vm->timeout;
+    if (enclosing <= 0 || deadline < enclosing) vm->deadline = deadline;
+    vm->deadlinePolls = DEADLINE_POLLS;
+    SAFE_POINT_SET(vm, SAFE_POINT_DEADLINE);
+    return enclosing;
+}
+
+static void endDeadline(MVM *vm, double enclosing) {
+    vm->deadline = enclosing;
+    if (enclosing > 0) {
+        SAFE_POINT_SET(vm, SAFE_POINT_DEADLINE);
+    } else {
+        SAFE_POINT_CLEAR(vm, SAFE_POINT_DEADLINE);
+    }
+}
+
+void MSCInterrupt(MVM *vm) {
+    SAFE_POINT_SET(vm, SAFE_POINT_INTERRUPT);
+}
+
+void MSCSetTimeout(MVM *vm, double milliseconds) {
+    vm->timeout = milliseconds > 0 ? milliseconds : 0;
+}
+
+void MSCSetFuel(MVM *vm, int64_t fuel) {
+    if (fuel < 0) {
+        vm->fuel = 0;
+        SAFE_POINT_CLEAR(vm, SAFE_POINT_FUEL);
+    } else {
+        vm->fuel = fuel;
+        SAFE_POINT_SET(vm, SAFE_POINT_FUEL);
+    }
+}
+
+int64_t MSCGetFuel(MVM *vm) {
+    return (SAFE_POINT_LOAD(vm) & SAFE_POINT_FUEL) ? vm->fuel : -1;
+}
+
 static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
 #if __cplusplus > 199711L
 #define register      // Deprecated in C++11.
 #endif  // #if __cplusplus > 199711L
     // Remember the current djuru so we can find it if a GC happens.
     vm->djuru = djuru;
-    djuru->state = DJURU_ROOT;
+    // A djuru the scheduler resumes may have been called by another one, and
+    // must still return to it.
+    if (djuru->caller == NULL) djuru->state = DJURU_ROOT;
 
     // Hoist these into local variables. They are accessed frequently in the loop
     // but assigned less frequently. Keeping them in locals and updating them when
@@ -793,6 +1032,23 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
         DISPATCH();                                                            \
       } while (false)
 
+    // Stops at a loop back-edge or a call if another thread, the deadline or
+    // the fuel asks to. Costs a single load otherwise. A suspended djuru goes
+    // on from [resume] in the current frame.
+#define CHECK_SAFE_POINT(resume)                                             \
+      do                                                                       \
+      {                                                                        \
+        if (SAFE_POINT_LOAD(vm) != 0) {                                        \
+          SafePointAction action = reachSafePoint(vm);                         \
+          if (action == SAFE_POINT_ABORT) RUNTIME_ERROR();                     \
+          if (action == SAFE_POINT_SUSPEND) {                                  \
+            frame->ip = (resume);                                              \
+            preempt(vm, djuru);                                                \
+            return RESULT_SUSPENDED;                                           \
+          }                                                                    \
+        }                                                                      \
+      } while (false)
+
 #if MSC_DEBUG_TRACE_INSTRUCTIONS
     // Prints the stack and instruction before each instruction is executed.
 #define DEBUG_TRACE_INSTRUCTIONS()                                         \
@@ -910,6 +1166,7 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
             STORE_FRAME();
             callFunction(vm, djuru, closure, numArgs);
             LOAD_FRAME();
+            CHECK_SAFE_POINT(ip);
             DISPATCH();
         }
 
@@ -957,6 +1214,19 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
             classObj = MSCGetClassInline(vm, args[0]);
             goto completeCall;
 
+            CASE_CODE(TO_STRING):
+            // Strings are interpolated as they are, without a call.
+            if (IS_STRING(PEEK())) {
+                ip += 2;
+                DISPATCH();
+            }
+            method = NULL;
+            numArgs = 1;
+            symbol = READ_SHORT();
+            args = djuru->stackTop - 1;
+            classObj = MSCGetClassInline(vm, args[0]);
+            goto completeCall;
+
             CASE_CODE(SUPER_0):
             CASE_CODE(SUPER_1):
             CASE_CODE(SUPER_2):
@@ -997,13 +1267,15 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
 
             switch (method->type) {
                 case METHOD_PRIMITIVE:
+                    // Stored first, since a primitive that pushes a frame may
+                    // move the frame array.
+                    STORE_FRAME();
                     if (method->as.primitive(vm, args)) {
                         // The result is now in the first arg slot. Discard the other
                         // stack slots.
                         djuru->stackTop -= numArgs - 1;
                     } else {
                         // An error, djuru switch, or call frame change occurred.
-                        STORE_FRAME();
                         // If we don't have a djuru to switch to, stop interpreting.
                         djuru = vm->djuru;
                         if (djuru == NULL) return RESULT_SUCCESS;
@@ -1021,6 +1293,7 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
                     STORE_FRAME();
                     method->as.primitive(vm, args);
                     LOAD_FRAME();
+                    CHECK_SAFE_POINT(ip);
                     break;
 
                 case METHOD_EXTERN:
@@ -1032,6 +1305,7 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
                     STORE_FRAME();
                     callFunction(vm, djuru, method->as.closure, numArgs);
                     LOAD_FRAME();
+                    CHECK_SAFE_POINT(ip);
                     break;
 
                 case METHOD_NONE:
@@ -1125,8 +1399,10 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
 
         CASE_CODE(LOOP):
         {
-            // Jump back to the top of the loop.
+            // Jump back to the top of the loop. Stopping happens before, so
+            // that an `ake` block starting with the loop still guards it.
             uint16_t offset = READ_SHORT();
+            CHECK_SAFE_POINT(ip - offset);
             ip -= offset;
             DISPATCH();
         }
@@ -1140,6 +1416,276 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
             DISPATCH();
         }
 
+        CASE_CODE(FOR_ITER):
+        {
+            // Where calls made by this instruction come back to, so that it
+            // starts over with their result.
+            uint8_t *start = ip - 1;
+            // The hidden locals of the loop: the sequence, the iterator and
+            // the step.
+            Value *loop = stackStart + READ_BYTE();
+            int iterateSymbol = READ_SHORT();
+            int valueSymbol = READ_SHORT();
+            uint16_t toTest = READ_SHORT();
+            uint16_t toBody = READ_SHORT();
+
+            Class *classObj = MSCGetClassInline(vm, loop[0]);
+
+            // Lists and ranges are stepped inline, with the same rules as
+            // list_iterate and range_iterate, unless a script replaced those.
+            // The iterator is always one this loop produced, so only the step
+            // needs checking.
+            if ((classObj == vm->core.listClass || classObj == vm->core.rangeClass) &&
+                hasNativeIteration(classObj, iterateSymbol, valueSymbol) &&
+                IS_NUM(loop[2]) && trunc(AS_NUM(loop[2])) == AS_NUM(loop[2]) &&
+                (IS_NULL(loop[1]) || IS_NUM(loop[1]))) {
+                double step = AS_NUM(loop[2]);
+                double index = 0;
+                bool done = false;
+
+                if (classObj == vm->core.listClass) {
+                    double count = AS_LIST(loop[0])->elements.count;
+                    if (IS_NULL(loop[1])) {
+                        done = count == 0;
+                        index = step > 0 ? 0 : count - 1;
+                    } else {
+                        index = AS_NUM(loop[1]);
+                        done = (step > 0 && (index < 0 || index >= count - 1)) ||
+                               (step < 0 && (index < 1 || index > count - 1));
+                        index += step;
+                    }
+                    // Leave a bad index to the generic path, which reports it.
+                    if (!done && (index < 0 || index >= count)) goto forIterPrimitive;
+                    if (!done) PUSH(AS_LIST(loop[0])->elements.data[(uint32_t) index]);
+                } else {
+                    Range *range = AS_RANGE(loop[0]);
+                    done = !rangeNext(range->from, range->to, range->isInclusive, step, loop[1], &index);
+                    if (!done) PUSH(NUM_VAL(index));
+                }
+
+                if (done) {
+                    loop[1] = FALSE_VAL;
+                    PUSH(FALSE_VAL);
+                    ip += toTest;
+                } else {
+                    loop[1] = NUM_VAL(index);
+                    ip += toBody;
+                }
+                DISPATCH();
+            }
+
+            // A Labolan is resumed in a frame on top of this one, and this
+            // instruction starts over once it produces a value or ends. While it
+            // runs, the iterator is the generator itself.
+            if (classObj == vm->core.generatorClass &&
+                hasNativeIteration(classObj, iterateSymbol, valueSymbol)) {
+                Generator *generator = AS_GENERATOR(loop[0]);
+                if (IS_GENERATOR(loop[1])) {
+                    if (isFalsyValue(POP())) {
+                        loop[1] = FALSE_VAL;
+                        PUSH(FALSE_VAL);
+                        ip += toTest;
+                    } else {
+                        loop[1] = TRUE_VAL;
+                        PUSH(generator->value);
+                        ip += toBody;
+                    }
+                    DISPATCH();
+                }
+
+                // Let the primitive end the loop or report a running generator.
+                if (generator->state != GENERATOR_SUSPENDED) goto forIterPrimitive;
+
+                loop[1] = loop[0];
+                PUSH(loop[0]);
+                ip = start;
+                STORE_FRAME();
+                resumeGenerator(vm, djuru, generator);
+                LOAD_FRAME();
+                DISPATCH();
+            }
+
+            // SiraTugun pipelines are run by MSCPipelineStep. The stage closures,
+            // and the iterate(_,_) and iteratorValue(_) methods of a sequence that
+            // is not a list, are called from here and resume this instruction
+            // with their result on the stack.
+            if (classObj == vm->core.pipelineClass && (IS_NULL(loop[1]) || IS_LIST(loop[1]))) {
+                Value *fields = AS_INSTANCE(loop[0])->fields;
+                ValueBuffer *stages = &AS_LIST(fields[PIPELINE_FIELD_ARGS])->elements;
+                ValueBuffer *kinds = &AS_LIST(fields[PIPELINE_FIELD_KINDS])->elements;
+                Value sequence = fields[PIPELINE_FIELD_SEQUENCE];
+                Class *sequenceClass = MSCGetClassInline(vm, sequence);
+                bool resuming = IS_LIST(loop[1]) &&
+                                AS_NUM(AS_LIST(loop[1])->elements.data[PIPELINE_WAITING]) != PIPELINE_READY;
+
+                // Leave anything this can't call to the script.
+                if (!resuming) {
+                    bool native = true;
+                    for (int i = 0; i < stages->count; i++) {
+                        if (AS_NUM(kinds->data[i]) <= 1 && !IS_CLOSURE(stages->data[i])) native = false;
+                    }
+                    // A generator's iterate(_,_) pushes a frame instead of
+                    // returning.
+                    if (sequenceClass == vm->core.generatorClass) native = false;
+                    int symbols[2] = {iterateSymbol, valueSymbol};
+                    for (int i = 0; i < 2; i++) {
+                        if (symbols[i] >= sequenceClass->methods.count ||
+                            (sequenceClass->methods.data[symbols[i]].type != METHOD_PRIMITIVE &&
+                             sequenceClass->methods.data[symbols[i]].type != METHOD_BLOCK)) {
+                            native = false;
+                        }
+                    }
+                    if (!native) goto forIterPrimitive;
+                    if (IS_NULL(loop[1])) loop[1] = OBJ_VAL(MSCPipelineStart(vm, loop[0], loop[2]));
+                }
+
+                Value *state = AS_LIST(loop[1])->elements.data;
+                Value answer = resuming ? POP() : NULL_VAL;
+                for (;;) {
+                    int next = MSCPipelineStep(state, answer);
+                    if (next == PIPELINE_DONE) {
+                        loop[1] = FALSE_VAL;
+                        PUSH(FALSE_VAL);
+                        ip += toTest;
+                        DISPATCH();
+                    }
+                    if (next == PIPELINE_READY) {
+                        PUSH(state[PIPELINE_VALUE]);
+                        ip += toBody;
+                        DISPATCH();
+                    }
+
+                    // Go back to the start of this instruction once the call returns.
+                    Value *callArgs = djuru->stackTop;
+                    if (next >= 0) {
+                        PUSH(stages->data[next]);
+                        PUSH(state[PIPELINE_VALUE]);
+                        if (!checkArity(vm, callArgs[0], 2)) RUNTIME_ERROR();
+                        ip = start;
+                        STORE_FRAME();
+                        callFunction(vm, djuru, AS_CLOSURE(callArgs[0]), 2);
+                        LOAD_FRAME();
+                        DISPATCH();
+                    }
+
+                    PUSH(sequence);
+                    PUSH(state[PIPELINE_ITERATOR]);
+                    if (next == PIPELINE_ITERATE) PUSH(state[PIPELINE_STEP]);
+                    Method *method = &sequenceClass->methods.data[next == PIPELINE_ITERATE ? iterateSymbol : valueSymbol];
+                    if (method->type == METHOD_BLOCK) {
+                        ip = start;
+                        STORE_FRAME();
+                        callFunction(vm, djuru, method->as.closure, (int) (djuru->stackTop - callArgs));
+                        LOAD_FRAME();
+                        DISPATCH();
+                    }
+                    if (!method->as.primitive(vm, callArgs)) RUNTIME_ERROR();
+                    answer = callArgs[0];
+                    djuru->stackTop = callArgs;
+                }
+            }
+
+            forIterPrimitive:
+            if (iterateSymbol >= classObj->methods.count ||
+                classObj->methods.data[iterateSymbol].type != METHOD_PRIMITIVE) {
+                DISPATCH();
+            }
+
+            // Call the primitives directly on the stack, the same way a call
+            // instruction would, but without dispatching through it.
+            Value *args = djuru->stackTop;
+            args[0] = loop[0];
+            args[1] = loop[1];
+            args[2] = loop[2];
+            djuru->stackTop += 3;
+            if (!classObj->methods.data[iterateSymbol].as.primitive(vm, args)) RUNTIME_ERROR();
+            djuru->stackTop = args + 1;
+            loop[1] = args[0];
+
+            // Let the exit test handle the end of the sequence, and the generic
+            // call handle a value that needs more than a primitive.
+            if (isFalsyValue(loop[1]) ||
+                valueSymbol >= classObj->methods.count ||
+                classObj->methods.data[valueSymbol].type != METHOD_PRIMITIVE) {
+                ip += toTest;
+                DISPATCH();
+            }
+
+            args[0] = loop[0];
+            args[1] = loop[1];
+            djuru->stackTop = args + 2;
+            if (!classObj->methods.data[valueSymbol].as.primitive(vm, args)) RUNTIME_ERROR();
+            djuru->stackTop = args + 1;
+            ip += toBody;
+            DISPATCH();
+        }
+
+        CASE_CODE(INTERPOLATE):
+        {
+            int numParts = READ_BYTE();
+            Value *parts = djuru->stackTop - numParts;
+            for (int i = 0; i < numParts; i++) {
+                if (!IS_STRING(parts[i])) {
+                    djuru->error = CONST_STRING(vm, "Interpolated value must be a string.");
+                    RUNTIME_ERROR();
+                }
+            }
+
+            // The parts stay on the stack while the result is allocated.
+            Value result = MSCStringJoin(vm, parts, numParts);
+            djuru->stackTop = parts;
+            PUSH(result);
+            DISPATCH();
+        }
+
+        CASE_CODE(FOR_RANGE_INIT):
+        {
+            // The hidden locals of the loop: the two bounds, the iterator and
+            // the step.
+            Value *loop = stackStart + READ_BYTE();
+            int symbol = READ_SHORT();
+            int iterateSymbol = READ_SHORT();
+            int valueSymbol = READ_SHORT();
+            uint16_t offset = READ_SHORT();
+
+            // An extension that redefines the range operator of Diat or the
+            // iteration of Funan, or bounds that are not numbers, need the
+            // range to be built.
+            Class *numClass = vm->core.numClass;
+            if (IS_NUM(loop[0]) && IS_NUM(loop[1]) &&
+                IS_NUM(loop[3]) && trunc(AS_NUM(loop[3])) == AS_NUM(loop[3]) &&
+                symbol < numClass->methods.count &&
+                numClass->methods.data[symbol].type == METHOD_PRIMITIVE &&
+                hasNativeIteration(vm->core.rangeClass, iterateSymbol, valueSymbol)) {
+                ip += offset;
+            }
+            DISPATCH();
+        }
+
+        CASE_CODE(FOR_RANGE):
+        {
+            Value *loop = stackStart + READ_BYTE();
+            bool isInclusive = READ_BYTE();
+            uint16_t toTest = READ_SHORT();
+            uint16_t toBody = READ_SHORT();
+
+            // The range was built, leave it to the generic calls.
+            if (!IS_NUM(loop[1])) DISPATCH();
+
+            double index = 0;
+            if (rangeNext(AS_NUM(loop[0]), AS_NUM(loop[1]), isInclusive,
+                          AS_NUM(loop[3]), loop[2], &index)) {
+                loop[2] = NUM_VAL(index);
+                PUSH(loop[2]);
+                ip += toBody;
+            } else {
+                loop[2] = FALSE_VAL;
+                PUSH(FALSE_VAL);
+                ip += toTest;
+            }
+            DISPATCH();
+        }
+
         CASE_CODE(AND):
         {
             uint16_t offset = READ_SHORT();
@@ -1190,14 +1736,15 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
 
             // If the djuru is complete, end it.
             if (djuru->numOfFrames == 0) {
+                if (djuru->waiters != NULL) MSCWakeWaiters(vm, djuru, result);
+
+                // Store the final result value at the beginning of the stack so the
+                // C API and makono() can get it.
+                djuru->stack[0] = result;
+                djuru->stackTop = djuru->stack + 1;
+
                 // See if there's another djuru to return to. If not, we're done.
-                if (djuru->caller == NULL) {
-                    // Store the final result value at the beginning of the stack so the
-                    // C API can get it.
-                    djuru->stack[0] = result;
-                    djuru->stackTop = djuru->stack + 1;
-                    return RESULT_SUCCESS;
-                }
+                if (djuru->caller == NULL) return RESULT_SUCCESS;
 
                 Djuru *resumingFiber = djuru->caller;
                 djuru->caller = NULL;
@@ -1220,6 +1767,53 @@ static MSCInterpretResult runInterpreter(MVM *vm, Djuru *djuru) {
             DISPATCH();
         }
 
+        CASE_CODE(GENERATOR):
+        {
+            Generator *generator = MSCGeneratorFrom(vm, frame->closure, stackStart,
+                                                    (int) (djuru->stackTop - stackStart));
+            // Skip the RETURN that follows.
+            generator->ip = ip + 1;
+            PUSH(OBJ_VAL(generator));
+            DISPATCH();
+        }
+
+        CASE_CODE(YIELD):
+        {
+            // The generator was resumed right below this frame.
+            Generator *generator = AS_GENERATOR(stackStart[-1]);
+            generator->value = PEEK();
+            djuru->stackTop[-1] = NULL_VAL;
+
+            // Closures over its locals keep the values they had here.
+            closeUpvalues(djuru, stackStart);
+
+            generator->numSlots = (int) (djuru->stackTop - stackStart);
+            memcpy(generator->slots, stackStart, sizeof(Value) * generator->numSlots);
+            generator->ip = ip;
+            generator->state = GENERATOR_SUSPENDED;
+
+            djuru->numOfFrames--;
+            stackStart[-1] = TRUE_VAL;
+            djuru->stackTop = stackStart;
+            LOAD_FRAME();
+            DISPATCH();
+        }
+
+        CASE_CODE(GENERATOR_END):
+        {
+            Generator *generator = AS_GENERATOR(stackStart[-1]);
+            closeUpvalues(djuru, stackStart);
+            generator->state = GENERATOR_DONE;
+            generator->value = NULL_VAL;
+            generator->numSlots = 0;
+
+            djuru->numOfFrames--;
+            stackStart[-1] = FALSE_VAL;
+            djuru->stackTop = stackStart;
+            LOAD_FRAME();
+            DISPATCH();
+        }
+
         CASE_CODE(CONSTRUCT):
         ASSERT(IS_CLASS(stackStart[0]), "'vm' should be a class.");
         stackStart[0] = OBJ_VAL(MSCInstanceFrom(vm, AS_CLASS(stackStart[0])));
@@ -1380,7 +1974,9 @@ MSCInterpretResult MSCCall(MVM *vm, MSCHandle *method) {
     vm->djuru->stackTop = &vm->djuru->stack[closure->fn->maxSlots];
 
     callFunction(vm, vm->djuru, closure, 0);
+    double enclosing = startDeadline(vm);
     MSCInterpretResult result = runInterpreter(vm, vm->djuru);
+    endDeadline(vm, enclosing);
 
     // If the call didn't abort, then set up the API stack to point to the
     // beginning of the stack so the host can access the call's return value.
@@ -1389,6 +1985,66 @@ MSCInterpretResult MSCCall(MVM *vm, MSCHandle *method) {
     return result;
 }
 
+int MSCRunScheduler(MVM *vm, int budget) {
+    ASSERT(!vm->scheduler.running, "Cannot run the scheduler from a djuru.");
+
+    int resumed = 0;
+    while (budget <= 0 || resumed < budget) {
+        // A djuru resumed with no fuel would only be suspended again.
+        if ((SAFE_POINT_LOAD(vm) & SAFE_POINT_FUEL) && vm->fuel <= 0) break;
+
+        MSCScheduleWake(vm, budget <= 0);
+
+        ReadyDjuru next;
+        if (!MSCSchedulePop(vm, &next)) {
+            // Waiting for an operation, a descriptor or a sleeping djuru may
+            // return before it is done, such as when an event is posted.
+            if (budget <= 0 && (vm->scheduler.pendingCount > 0 ||
+                                vm->scheduler.pollingCount > 0 ||
+                                vm->scheduler.sleepingCount > 0)) {
+                continue;
+            }
+            break;
+        }
+
+        Djuru *djuru = next.djuru;
+        if (djuru->numOfFrames == 0 || MSCHasError(djuru)) continue;
+
+        if (next.isError) {
+            // Abort it as if the call that suspended it failed, and carry on
+            // with whoever catches the error, if any.
+            djuru->error = next.value;
+            vm->djuru = djuru;
+            runtimeError(vm);
+            if (vm->djuru == NULL) continue;
+            djuru = vm->djuru;
+        } else if (djuru->numOfFrames == 1 &&
+            djuru->frames[0].ip == djuru->frames[0].closure->fn->code.data) {
+            // The djuru is being started for the first time. If its function
+            // takes a parameter, bind the value to it.
+            if (djuru->frames[0].closure->fn->arity == 1) {
+                *djuru->stackTop++ = next.value;
+            }
+        } else if (djuru->preempted) {
+            // It stopped at a loop or a call, with no call to return a value.
+            djuru->preempted = false;
+        } else {
+            // Make the call that suspended it return the value.
+            djuru->stackTop[-1] = next.value;
+        }
+
+        vm->apiStack = NULL;
+        vm->scheduler.running = true;
+        runInterpreter(vm, djuru);
+        vm->scheduler.running = false;
+        resumed++;
+    }
+
+    vm->djuru = NULL;
+    vm->apiStack = NULL;
+    return MSCScheduleWaiting(vm);
+}
+
 
 Value MSCGetModuleVariable(MVM *vm, Value moduleName, Value variableName) {
     Module *module = MSCGetModule(vm, moduleName);
@@ -1492,6 +2148,9 @@ MSCType MSCGetSlotType(MVM *vm, int slot) {
     if (IS_MAP(vm->apiStack[slot])) return MSC_TYPE_MAP;
     if (IS_NULL(vm->apiStack[slot])) return MSC_TYPE_NULL;
     if (IS_STRING(vm->apiStack[slot])) return MSC_TYPE_STRING;
+    if (IS_TYPED_ARRAY(vm->apiStack[slot]) && AS_TYPED_ARRAY(vm->apiStack[slot])->kind == TYPED_UINT8) {
+        return MSC_TYPE_BUFFER;
+    }
 
     return MSC_TYPE_UNKNOWN;
 }
@@ -1512,6 +2171,16 @@ const char *MSCGetSlotBytes(MVM *vm, int slot, int *length) {
     return string->value;
 }
 
+uint8_t *MSCGetSlotBuffer(MVM *vm, int slot, size_t *length) {
+    validateApiSlot(vm, slot);
+    ASSERT(IS_TYPED_ARRAY(vm->apiStack[slot]) && AS_TYPED_ARRAY(vm->apiStack[slot])->kind == TYPED_UINT8,
+           "Slot must hold a Uint8Walan.");
+
+    TypedArray *array = AS_TYPED_ARRAY(vm->apiStack[slot]);
+    *length = array->count;
+    return (uint8_t *) array->data;
+}
+
 double MSCGetSlotDouble(MVM *vm, int slot) {
     validateApiSlot(vm, slot);
     ASSERT(IS_NUM(vm->apiStack[slot]), "Slot must hold a number.");
@@ -1553,6 +2222,12 @@ void MSCSetSlotBytes(MVM *vm, int slot, const char *bytes, size_t length) {
     setSlot(vm, slot, MSCStringFromCharsWithLength(vm, bytes, (uint32_t) length));
 }
 
+uint8_t *MSCSetSlotNewBuffer(MVM *vm, int slot, size_t length) {
+    TypedArray *array = MSCTypedArrayFrom(vm, TYPED_UINT8, (uint32_t) length);
+    setSlot(vm, slot, OBJ_VAL(array));
+    return (uint8_t *) array->data;
+}
+
 void MSCSetSlotDouble(MVM *vm, int slot, double value) {
     setSlot(vm, slot, NUM_VAL(value));
 }
@@ -1841,7 +2516,9 @@ MSCInterpretResult MSCInterpret(MVM *vm, const char *module,
     MSCPopRoot(vm->gc); // closure.
     vm->apiStack = NULL;
 
-    // return RESULT_SUCCESS;
-    return runInterpreter(vm, thread);
+    double enclosing = startDeadline(vm);
+    MSCInterpretResult result = runInterpreter(vm, thread);
+    endDeadline(vm, enclosing);
+    return result;
 }
 
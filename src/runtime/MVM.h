@@ -8,10 +8,34 @@
 
 #include "../memory/Value.h"
 #include "../memory/GC.h"
+#include "../memory/DjuruPool.h"
 #include "../compiler/Compiler.h"
 #include "../builtin/Core.h"
 #include "../api/msc.h"
-
+#include "Workers.h"
+#include "Scheduler.h"
+
+
+// What can make the interpreter stop at its next loop back-edge or call.
+typedef enum {
+    // [MSCInterrupt] was called.
+    SAFE_POINT_INTERRUPT = 1 << 0,
+    // The call from the host has a deadline.
+    SAFE_POINT_DEADLINE = 1 << 1,
+    // The work is metered with [MSCSetFuel].
+    SAFE_POINT_FUEL = 1 << 2
+} SafePoint;
+
+// [MVM.safePoint] may be set from any thread.
+#if MSC_OPT_THREADS
+#define SAFE_POINT_LOAD(vm) __atomic_load_n(&(vm)->safePoint, __ATOMIC_RELAXED)
+#define SAFE_POINT_SET(vm, bits) __atomic_fetch_or(&(vm)->safePoint, (bits), __ATOMIC_RELAXED)
+#define SAFE_POINT_CLEAR(vm, bits) __atomic_fetch_and(&(vm)->safePoint, ~(bits), __ATOMIC_RELAXED)
+#else
+#define SAFE_POINT_LOAD(vm) ((vm)->safePoint)
+#define SAFE_POINT_SET(vm, bits) ((vm)->safePoint |= (bits))
+#define SAFE_POINT_CLEAR(vm, bits) ((vm)->safePoint &= ~(bits))
+#endif
 
 struct MSCHandle {
     Value value;
@@ -32,6 +56,22 @@ struct MVM {
     GC *gc;
     MSCHandle *handles;
     Value *apiStack;
+    Workers *workers;
+    Scheduler scheduler;
+    DjuruPool djuruPool;
+
+    // The [SafePoint] bits that are set. The interpreter only looks further
+    // when it is not zero.
+    int safePoint;
+    // The time given to each call from the host, in milliseconds, or 0.
+    double timeout;
+    // When the running call from the host times out, in milliseconds of
+    // [MSCMonotonicMillis], and the safe points left before the clock is read
+    // again.
+    double deadline;
+    int deadlinePolls;
+    // The fuel left while [SAFE_POINT_FUEL] is set.
+    int64_t fuel;
 
 };
 
@@ -105,17 +145,27 @@ static inline Class *MSCGetClassInline(MVM *vm, Value value) {
     return NULL;
 }
 
+// Makes room in [djuru] for one more call frame.
+static inline void ensureFrame(MVM *vm, Djuru *djuru) {
+    if (djuru->numOfFrames + 1 > djuru->frameCapacity) {
+        int max = djuru->frameCapacity * 2;
+        CallFrame *frames = MSCTakeFrames(vm, max);
+        memcpy(frames, djuru->frames, sizeof(CallFrame) * djuru->numOfFrames);
+        // A small djuru's first frames are part of it.
+        if (!djuru->small || djuru->frames != ((SmallDjuru *) djuru)->frames) {
+            MSCGiveFrames(vm, djuru->frames, djuru->frameCapacity);
+        }
+        djuru->frames = frames;
+        djuru->frameCapacity = max;
+    }
+}
+
 // Pushes [closure] onto [fiber]'s callstack to invoke it. Expects [numArgs]
 // arguments (including the receiver) to be on the top of the stack already.
 static inline void callFunction(MVM *vm, Djuru *djuru,
                                 Closure *closure, int numArgs) {
     // Grow the call frame array if needed.
-    if (djuru->numOfFrames + 1 > djuru->frameCapacity) {
-        int max = djuru->frameCapacity * 2;
-        djuru->frames = (CallFrame *) MSCReallocate(vm->gc, djuru->frames,
-                                                    sizeof(CallFrame) * djuru->frameCapacity, sizeof(CallFrame) * max);
-        djuru->frameCapacity = max;
-    }
+    ensureFrame(vm, djuru);
 
     // Grow the stack if needed.
     int stackSize = (int) (djuru->stackTop - djuru->stack);
@@ -125,6 +175,23 @@ static inline void callFunction(MVM *vm, Djuru *djuru,
     MSCAppendCallFrame(djuru, closure, djuru->stackTop - numArgs);
 }
 
+// Resumes [generator], which is on top of the stack, in a new frame of
+// [djuru]. Its slots are restored just above it. When it produces a value or
+// ends, it leaves `tien` or `galon` in its place.
+static inline void resumeGenerator(MVM *vm, Djuru *djuru, Generator *generator) {
+    ensureFrame(vm, djuru);
+
+    int stackSize = (int) (djuru->stackTop - djuru->stack);
+    MSCEnsureStack(djuru, vm, stackSize + generator->capacity);
+
+    Value *stackStart = djuru->stackTop;
+    memcpy(stackStart, generator->slots, sizeof(Value) * generator->numSlots);
+    djuru->stackTop += generator->numSlots;
+    MSCAppendCallFrame(djuru, generator->closure, stackStart);
+    djuru->frames[djuru->numOfFrames - 1].ip = generator->ip;
+    generator->state = GENERATOR_RUNNING;
+}
+
 static inline bool isFalsyValue(Value value) {
     return IS_FALSE(value) || IS_NULL(value);
 }
@@ -0,0 +1,792 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "Scheduler.h"
+#include "MVM.h"
+
+#include <errno.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if MSC_OPT_THREADS
+#include <pthread.h>
+#endif
+
+#if MSC_OPT_POLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#define MIN_READY_CAPACITY 16
+#define MIN_SLEEPING_CAPACITY 8
+#define POLL_EVENTS 64
+
+double MSCMonotonicMillis(void) {
+#if defined(_WIN32)
+    return (double) GetTickCount64();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec * 1000.0 + (double) now.tv_nsec / 1000000.0;
+#endif
+}
+
+static void sleepMillis(double ms) {
+#if defined(_WIN32)
+    Sleep((DWORD) ms);
+#else
+    struct timespec duration;
+    duration.tv_sec = (time_t) (ms / 1000.0);
+    duration.tv_nsec = (long) ((ms - (double) duration.tv_sec * 1000.0) * 1000000.0);
+    nanosleep(&duration, NULL);
+#endif
+}
+
+static void pushReady(MVM *vm, Djuru *djuru, Value value, bool isError) {
+    Scheduler *scheduler = &vm->scheduler;
+    if (scheduler->readyCount == scheduler->readyCapacity) {
+        int capacity = scheduler->readyCapacity == 0 ? MIN_READY_CAPACITY
+                                                     : scheduler->readyCapacity * 2;
+        // Growing the queue may collect garbage before the djuru is in it.
+        MSCPushRoot(vm->gc, (Object *) djuru);
+        if (IS_OBJ(value)) MSCPushRoot(vm->gc, AS_OBJ(value));
+        ReadyDjuru *ready = ALLOCATE_ARRAY(vm, ReadyDjuru, capacity);
+        if (IS_OBJ(value)) MSCPopRoot(vm->gc);
+        MSCPopRoot(vm->gc);
+        // Unwrap the ring so the queue starts at the beginning again.
+        for (int i = 0; i < scheduler->readyCount; i++) {
+            ready[i] = scheduler->ready[(scheduler->readyHead + i) & (scheduler->readyCapacity - 1)];
+        }
+        DEALLOCATE(vm, scheduler->ready);
+        scheduler->ready = ready;
+        scheduler->readyHead = 0;
+        scheduler->readyCapacity = capacity;
+    }
+
+    int tail = (scheduler->readyHead + scheduler->readyCount) & (scheduler->readyCapacity - 1);
+    scheduler->ready[tail].djuru = djuru;
+    scheduler->ready[tail].value = value;
+    scheduler->ready[tail].isError = isError;
+    scheduler->readyCount++;
+    djuru->scheduled = true;
+}
+
+void MSCScheduleReady(MVM *vm, Djuru *djuru, Value value) {
+    pushReady(vm, djuru, value, false);
+}
+
+void MSCScheduleError(MVM *vm, Djuru *djuru, Value error) {
+    pushReady(vm, djuru, error, true);
+}
+
+static bool sleepsBefore(SleepingDjuru *a, SleepingDjuru *b) {
+    return a->time < b->time || (a->time == b->time && a->order < b->order);
+}
+
+void MSCScheduleSleep(MVM *vm, Djuru *djuru, double ms) {
+    Scheduler *scheduler = &vm->scheduler;
+    if (scheduler->sleepingCount == scheduler->sleepingCapacity) {
+        int capacity = scheduler->sleepingCapacity == 0 ? MIN_SLEEPING_CAPACITY
+                                                        : scheduler->sleepingCapacity * 2;
+        scheduler->sleeping = (SleepingDjuru *) MSCReallocate(
+                vm->gc, scheduler->sleeping,
+                sizeof(SleepingDjuru) * scheduler->sleepingCapacity,
+                sizeof(SleepingDjuru) * capacity);
+        scheduler->sleepingCapacity = capacity;
+    }
+
+    SleepingDjuru entry;
+    entry.time = MSCMonotonicMillis() + (ms > 0 ? ms : 0);
+    entry.order = scheduler->sleepingOrder++;
+    entry.djuru = djuru;
+
+    // Sift the new entry up.
+    SleepingDjuru *heap = scheduler->sleeping;
+    int i = scheduler->sleepingCount++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!sleepsBefore(&entry, &heap[parent])) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = entry;
+    djuru->scheduled = true;
+}
+
+// Removes the first sleeping djuru from the heap.
+static Djuru *popSleeping(Scheduler *scheduler) {
+    SleepingDjuru *heap = scheduler->sleeping;
+    Djuru *first = heap[0].djuru;
+    SleepingDjuru last = heap[--scheduler->sleepingCount];
+
+    // Sift the last entry down from the root.
+    int count = scheduler->sleepingCount;
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= count) break;
+        if (child + 1 < count && sleepsBefore(&heap[child + 1], &heap[child])) child++;
+        if (!sleepsBefore(&heap[child], &last)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (count > 0) heap[i] = last;
+    return first;
+}
+
+void MSCScheduleJoin(MVM *vm, Djuru *waiter, Djuru *djuru) {
+    waiter->nextWaiter = djuru->waiters;
+    djuru->waiters = waiter;
+    vm->scheduler.joining++;
+}
+
+void MSCWakeWaiters(MVM *vm, Djuru *djuru, Value result) {
+    // Wake them in the order they started waiting.
+    Djuru *reversed = NULL;
+    while (djuru->waiters != NULL) {
+        Djuru *waiter = djuru->waiters;
+        djuru->waiters = waiter->nextWaiter;
+        waiter->nextWaiter = reversed;
+        reversed = waiter;
+    }
+
+    // The waiters are only reachable from the list now, so keep it as the
+    // djuru's while they are queued, in case that collects garbage. The djuru
+    // itself may already be unhooked from the one that called it.
+    djuru->waiters = reversed;
+    MSCPushRoot(vm->gc, (Object *) djuru);
+    while (djuru->waiters != NULL) {
+        Djuru *waiter = djuru->waiters;
+        MSCScheduleReady(vm, waiter, result);
+        djuru->waiters = waiter->nextWaiter;
+        waiter->nextWaiter = NULL;
+        vm->scheduler.joining--;
+    }
+    MSCPopRoot(vm->gc);
+}
+
+#if MSC_OPT_POLL
+
+struct Poller {
+    int epollFd;
+    // Written by the I/O threads when an operation is done, so that waiting
+    // for a descriptor also wakes up for it.
+    int wakeFd;
+};
+
+#endif
+
+#if MSC_OPT_THREADS
+
+struct AsyncThreads {
+    pthread_mutex_t lock;
+    // Signaled when an operation is queued or the threads must stop.
+    pthread_cond_t queued;
+    // Signaled when an operation is done.
+    pthread_cond_t done;
+
+    // The operations waiting for a thread, and the ones done waiting for the
+    // thread of the VM, both in order.
+    AsyncOp *queueHead;
+    AsyncOp *queueTail;
+    AsyncOp *doneHead;
+    AsyncOp *doneTail;
+    bool stopping;
+    // The descriptor to signal when an operation is done, or -1.
+    int wakeFd;
+
+    int threadCount;
+    pthread_t threads[ASYNC_THREADS];
+};
+
+static void *asyncMain(void *arg) {
+    AsyncThreads *threads = (AsyncThreads *) arg;
+    pthread_mutex_lock(&threads->lock);
+    for (;;) {
+        while (threads->queueHead == NULL && !threads->stopping) {
+            pthread_cond_wait(&threads->queued, &threads->lock);
+        }
+        if (threads->stopping) break;
+
+        AsyncOp *op = threads->queueHead;
+        threads->queueHead = op->next;
+        if (threads->queueHead == NULL) threads->queueTail = NULL;
+
+        pthread_mutex_unlock(&threads->lock);
+        op->work(op);
+        pthread_mutex_lock(&threads->lock);
+
+        op->next = NULL;
+        if (threads->doneTail == NULL) {
+            threads->doneHead = op;
+        } else {
+            threads->doneTail->next = op;
+        }
+        threads->doneTail = op;
+        pthread_cond_signal(&threads->done);
+#if MSC_OPT_POLL
+        if (threads->wakeFd != -1) {
+            uint64_t one = 1;
+            ssize_t written = write(threads->wakeFd, &one, sizeof(one));
+            (void) written;
+        }
+#endif
+    }
+    pthread_mutex_unlock(&threads->lock);
+    return NULL;
+}
+
+// Returns the I/O threads of [vm], starting them the first time, or NULL if
+// none could be started.
+static AsyncThreads *asyncThreads(MVM *vm) {
+    Scheduler *scheduler = &vm->scheduler;
+    if (scheduler->threads != NULL) {
+        return scheduler->threads->threadCount > 0 ? scheduler->threads : NULL;
+    }
+
+    AsyncThreads *threads = ALLOCATE(vm, AsyncThreads);
+    pthread_mutex_init(&threads->lock, NULL);
+    pthread_cond_init(&threads->queued, NULL);
+    pthread_cond_init(&threads->done, NULL);
+    threads->queueHead = threads->queueTail = NULL;
+    threads->doneHead = threads->doneTail = NULL;
+    threads->stopping = false;
+    threads->wakeFd = -1;
+#if MSC_OPT_POLL
+    if (scheduler->poller != NULL) threads->wakeFd = scheduler->poller->wakeFd;
+#endif
+    threads->threadCount = 0;
+    for (int i = 0; i < ASYNC_THREADS; i++) {
+        if (pthread_create(&threads->threads[i], NULL, asyncMain, threads) != 0) break;
+        threads->threadCount++;
+    }
+
+    scheduler->threads = threads;
+    return threads->threadCount > 0 ? threads : NULL;
+}
+
+#endif
+
+AsyncOp *MSCNewAsyncOp(MVM *vm, size_t size, MSCAsyncWorkFn work,
+                       MSCAsyncDoneFn done, MSCAsyncReleaseFn release) {
+    AsyncOp *op = (AsyncOp *) MSCReallocate(vm->gc, NULL, 0, size);
+    memset(op, 0, size);
+    op->djuru = vm->djuru;
+    op->keep = NULL_VAL;
+    op->work = work;
+    op->done = done;
+    op->release = release;
+    return op;
+}
+
+// Makes the djuru waiting for [op] ready with its result, and frees it.
+static void finishAsync(MVM *vm, AsyncOp *op) {
+    Scheduler *scheduler = &vm->scheduler;
+
+    // [op] stays pending until its djuru is queued, so that both the djuru and
+    // the result are reachable if that collects garbage.
+    bool isError = false;
+    Value result = op->done(vm, op, &isError);
+    if (IS_OBJ(result)) MSCPushRoot(vm->gc, AS_OBJ(result));
+    pushReady(vm, op->djuru, result, isError);
+    if (IS_OBJ(result)) MSCPopRoot(vm->gc);
+
+    if (op->prevPending == NULL) {
+        scheduler->pending = op->nextPending;
+    } else {
+        op->prevPending->nextPending = op->nextPending;
+    }
+    if (op->nextPending != NULL) op->nextPending->prevPending = op->prevPending;
+    scheduler->pendingCount--;
+
+    if (op->release != NULL) op->release(vm, op);
+    DEALLOCATE(vm, op);
+}
+
+void MSCScheduleAsync(MVM *vm, AsyncOp *op) {
+    Scheduler *scheduler = &vm->scheduler;
+    op->prevPending = NULL;
+    op->nextPending = scheduler->pending;
+    if (scheduler->pending != NULL) scheduler->pending->prevPending = op;
+    scheduler->pending = op;
+    scheduler->pendingCount++;
+
+#if MSC_OPT_THREADS
+    AsyncThreads *threads = asyncThreads(vm);
+    if (threads != NULL) {
+        op->next = NULL;
+        pthread_mutex_lock(&threads->lock);
+        if (threads->queueTail == NULL) {
+            threads->queueHead = op;
+        } else {
+            threads->queueTail->next = op;
+        }
+        threads->queueTail = op;
+        pthread_cond_signal(&threads->queued);
+        pthread_mutex_unlock(&threads->lock);
+        return;
+    }
+#endif
+
+    op->work(op);
+    finishAsync(vm, op);
+}
+
+// Finishes the operations the I/O threads are done with. If [wait] is true
+// and there are none, first blocks until one is done or [deadline], in
+// milliseconds, if it is not negative.
+static void finishDoneAsync(MVM *vm, bool wait, double deadline) {
+#if MSC_OPT_THREADS
+    AsyncThreads *threads = vm->scheduler.threads;
+    if (threads == NULL || vm->scheduler.pendingCount == 0) return;
+
+    pthread_mutex_lock(&threads->lock);
+    if (wait && threads->doneHead == NULL) {
+        if (deadline < 0) {
+            pthread_cond_wait(&threads->done, &threads->lock);
+        } else {
+            double ms = deadline - MSCMonotonicMillis();
+            if (ms > 0) {
+                // Condition variables wait on the wall clock.
+                struct timespec until;
+                clock_gettime(CLOCK_REALTIME, &until);
+                double nanos = (double) until.tv_nsec + ms * 1000000.0;
+                until.tv_sec += (time_t) (nanos / 1000000000.0);
+                until.tv_nsec = (long) (nanos - (double) (time_t) (nanos / 1000000000.0) * 1000000000.0);
+                pthread_cond_timedwait(&threads->done, &threads->lock, &until);
+            }
+        }
+    }
+    AsyncOp *op = threads->doneHead;
+    threads->doneHead = threads->doneTail = NULL;
+    pthread_mutex_unlock(&threads->lock);
+
+    while (op != NULL) {
+        AsyncOp *next = op->next;
+        finishAsync(vm, op);
+        op = next;
+    }
+#else
+    (void) vm;
+    (void) wait;
+    (void) deadline;
+#endif
+}
+
+static void linkPolling(Scheduler *scheduler, PollWait *wait) {
+    wait->prev = NULL;
+    wait->next = scheduler->polling;
+    if (scheduler->polling != NULL) scheduler->polling->prev = wait;
+    scheduler->polling = wait;
+}
+
+static void unlinkPolling(Scheduler *scheduler, PollWait *wait) {
+    if (wait->prev == NULL) {
+        scheduler->polling = wait->next;
+    } else {
+        wait->prev->next = wait->next;
+    }
+    if (wait->next != NULL) wait->next->prev = wait->prev;
+    wait->prev = wait->next = NULL;
+}
+
+// Makes the djurus parked on [wait] ready if [read] or [write] says they can
+// go on, and returns whether any is still parked. Each is queued before it is
+// unparked, so that it stays reachable if growing the queue collects garbage.
+static bool unpark(MVM *vm, PollWait *wait, bool read, bool write) {
+    Scheduler *scheduler = &vm->scheduler;
+    if (read && wait->reader != NULL) {
+        MSCScheduleReady(vm, wait->reader, NULL_VAL);
+        wait->reader = NULL;
+        scheduler->pollingCount--;
+    }
+    if (write && wait->writer != NULL) {
+        MSCScheduleReady(vm, wait->writer, NULL_VAL);
+        wait->writer = NULL;
+        scheduler->pollingCount--;
+    }
+    if (wait->reader != NULL || wait->writer != NULL) return true;
+
+    unlinkPolling(scheduler, wait);
+    return false;
+}
+
+#if MSC_OPT_POLL
+
+// Returns the poller of [vm], making it the first time, or NULL if it cannot
+// be made.
+static Poller *getPoller(MVM *vm) {
+    Scheduler *scheduler = &vm->scheduler;
+    if (scheduler->poller != NULL) return scheduler->poller;
+
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd == -1) return NULL;
+    int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (wakeFd == -1 || epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) != 0) {
+        int error = errno;
+        if (wakeFd != -1) close(wakeFd);
+        close(epollFd);
+        errno = error;
+        return NULL;
+    }
+
+    Poller *poller = ALLOCATE(vm, Poller);
+    poller->epollFd = epollFd;
+    poller->wakeFd = wakeFd;
+    // Posting threads read it to wake the scheduler up.
+#if MSC_OPT_THREADS
+    __atomic_store_n(&scheduler->poller, poller, __ATOMIC_RELEASE);
+#else
+    scheduler->poller = poller;
+#endif
+
+#if MSC_OPT_THREADS
+    AsyncThreads *threads = scheduler->threads;
+    if (threads != NULL) {
+        pthread_mutex_lock(&threads->lock);
+        threads->wakeFd = wakeFd;
+        pthread_mutex_unlock(&threads->lock);
+    }
+#endif
+    return poller;
+}
+
+// Watches the descriptor of [wait] for what its parked djurus wait for. It is
+// watched for one event at a time, so it needs no unwatching while nobody
+// waits for it.
+static bool arm(Poller *poller, PollWait *wait) {
+    struct epoll_event event;
+    event.events = EPOLLONESHOT;
+    if (wait->reader != NULL) event.events |= EPOLLIN;
+    if (wait->writer != NULL) event.events |= EPOLLOUT;
+    event.data.ptr = wait;
+    if (epoll_ctl(poller->epollFd, wait->added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                  wait->fd, &event) != 0) {
+        return false;
+    }
+    wait->added = true;
+    return true;
+}
+
+bool MSCSchedulePoll(MVM *vm, PollWait *wait, bool write) {
+    Scheduler *scheduler = &vm->scheduler;
+    Poller *poller = getPoller(vm);
+    if (poller == NULL) return false;
+
+    bool linked = wait->reader != NULL || wait->writer != NULL;
+    Djuru **slot = write ? &wait->writer : &wait->reader;
+    ASSERT(*slot == NULL, "Only one djuru may wait for a descriptor at a time.");
+
+    *slot = vm->djuru;
+    if (!arm(poller, wait)) {
+        *slot = NULL;
+        return false;
+    }
+
+    if (!linked) linkPolling(scheduler, wait);
+    scheduler->pollingCount++;
+    return true;
+}
+
+void MSCScheduleUnpoll(MVM *vm, PollWait *wait) {
+    Scheduler *scheduler = &vm->scheduler;
+    if (wait->added && scheduler->poller != NULL) {
+        epoll_ctl(scheduler->poller->epollFd, EPOLL_CTL_DEL, wait->fd, NULL);
+    }
+    wait->added = false;
+
+    if (wait->reader != NULL || wait->writer != NULL) unpark(vm, wait, true, true);
+}
+
+// Makes the djurus whose descriptor is ready, waiting up to [timeout]
+// milliseconds for one, or forever if it is negative.
+static void pollDescriptors(MVM *vm, int timeout) {
+    Scheduler *scheduler = &vm->scheduler;
+    struct epoll_event events[POLL_EVENTS];
+    int count = epoll_wait(scheduler->poller->epollFd, events, POLL_EVENTS, timeout);
+
+    for (int i = 0; i < count; i++) {
+        PollWait *wait = (PollWait *) events[i].data.ptr;
+        if (wait == NULL) {
+            // An I/O thread is done with an operation.
+            uint64_t value;
+            ssize_t result = read(scheduler->poller->wakeFd, &value, sizeof(value));
+            (void) result;
+            continue;
+        }
+        if (wait->reader == NULL && wait->writer == NULL) continue;
+
+        // Errors and hang ups wake both, to see them when they retry.
+        uint32_t ready = events[i].events;
+        bool failed = (ready & (EPOLLERR | EPOLLHUP)) != 0;
+        if (unpark(vm, wait, failed || (ready & EPOLLIN), failed || (ready & EPOLLOUT)) &&
+            !arm(scheduler->poller, wait)) {
+            unpark(vm, wait, true, true);
+        }
+    }
+}
+
+#else
+
+bool MSCSchedulePoll(MVM *vm, PollWait *wait, bool write) {
+    (void) vm;
+    (void) wait;
+    (void) write;
+    errno = ENOSYS;
+    return false;
+}
+
+void MSCScheduleUnpoll(MVM *vm, PollWait *wait) {
+    if (wait->reader != NULL || wait->writer != NULL) unpark(vm, wait, true, true);
+}
+
+#endif
+
+bool MSCPostEvent(MVM *vm, MSCHandle *handle, const void *bytes, size_t length) {
+    ASSERT(handle != NULL, "Handle cannot be NULL.");
+
+    // The handle's value never changes, so it can be read from any thread.
+    Value fn = handle->value;
+    if (!IS_CLOSURE(fn) || AS_CLOSURE(fn)->fn->arity > 1) return false;
+
+    // The VM's allocator is called directly, since the GC is not ours to
+    // touch from here.
+    PostedEvent *event = (PostedEvent *) vm->config.reallocateFn(
+            NULL, sizeof(PostedEvent) + length, vm->config.userData);
+    if (event == NULL) return false;
+    event->handle = handle;
+    event->length = length;
+    if (length > 0) memcpy(event->bytes, bytes, length);
+
+    Scheduler *scheduler = &vm->scheduler;
+#if MSC_OPT_THREADS
+    event->next = __atomic_load_n(&scheduler->posted, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&scheduler->posted, &event->next, event, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {}
+#else
+    event->next = scheduler->posted;
+    scheduler->posted = event;
+#endif
+
+#if MSC_OPT_POLL
+#if MSC_OPT_THREADS
+    Poller *poller = __atomic_load_n(&scheduler->poller, __ATOMIC_ACQUIRE);
+#else
+    Poller *poller = scheduler->poller;
+#endif
+    if (poller != NULL) {
+        uint64_t one = 1;
+        ssize_t written = write(poller->wakeFd, &one, sizeof(one));
+        (void) written;
+    }
+#endif
+    return true;
+}
+
+// Takes the events posted so far and starts a djuru for each, in the order
+// they were posted, calling the function of the event's handle with its bytes
+// in a new Uint8Walan.
+static void dispatchEvents(MVM *vm) {
+    Scheduler *scheduler = &vm->scheduler;
+#if MSC_OPT_THREADS
+    if (__atomic_load_n(&scheduler->posted, __ATOMIC_RELAXED) == NULL) return;
+    PostedEvent *newest = __atomic_exchange_n(&scheduler->posted, NULL, __ATOMIC_ACQUIRE);
+#else
+    PostedEvent *newest = scheduler->posted;
+    scheduler->posted = NULL;
+#endif
+    if (newest == NULL) return;
+
+    PostedEvent *event = NULL;
+    while (newest != NULL) {
+        PostedEvent *next = newest->next;
+        newest->next = event;
+        event = newest;
+        newest = next;
+    }
+
+#if MSC_OPT_POLL
+    // From now on, waiting goes through the poller, which posting wakes up.
+    getPoller(vm);
+#endif
+
+    while (event != NULL) {
+        PostedEvent *next = event->next;
+        // MSCPostEvent only queues events for functions taking at most one
+        // parameter.
+        Value fn = event->handle->value;
+
+        TypedArray *payload = MSCTypedArrayFrom(vm, TYPED_UINT8, (uint32_t) event->length);
+        if (event->length > 0) memcpy(payload->data, event->bytes, event->length);
+        MSCPushRoot(vm->gc, (Object *) payload);
+        Djuru *djuru = MSCDjuruFrom(vm, AS_CLOSURE(fn));
+        MSCPushRoot(vm->gc, (Object *) djuru);
+        MSCScheduleReady(vm, djuru, OBJ_VAL(payload));
+        MSCPopRoot(vm->gc);
+        MSCPopRoot(vm->gc);
+
+        vm->config.reallocateFn(event, 0, vm->config.userData);
+        event = next;
+    }
+}
+
+void MSCScheduleWake(MVM *vm, bool wait) {
+    Scheduler *scheduler = &vm->scheduler;
+    finishDoneAsync(vm, false, -1);
+    dispatchEvents(vm);
+
+    if (wait && scheduler->readyCount == 0) {
+        double next = scheduler->sleepingCount > 0 ? scheduler->sleeping[0].time : -1;
+#if MSC_OPT_POLL
+        // Once there is a poller, every wait goes through it, since the I/O
+        // threads and posted events wake it up.
+        if (scheduler->pollingCount > 0 ||
+            (scheduler->poller != NULL && (scheduler->pendingCount > 0 || next >= 0))) {
+            int timeout = -1;
+            if (next >= 0) {
+                double ms = next - MSCMonotonicMillis();
+                timeout = ms > 0 ? (int) ms + 1 : 0;
+            }
+            pollDescriptors(vm, timeout);
+            finishDoneAsync(vm, false, -1);
+            dispatchEvents(vm);
+        } else
+#endif
+        if (scheduler->pendingCount > 0) {
+            finishDoneAsync(vm, true, next);
+        } else if (next >= 0) {
+            double now = MSCMonotonicMillis();
+            if (next > now) sleepMillis(next - now);
+        }
+    }
+#if MSC_OPT_POLL
+    else if (scheduler->pollingCount > 0) {
+        // Don't let the ready djurus starve the parked ones.
+        pollDescriptors(vm, 0);
+    }
+#endif
+
+    if (scheduler->sleepingCount == 0) return;
+
+    double now = MSCMonotonicMillis();
+
+    while (scheduler->sleepingCount > 0 && scheduler->sleeping[0].time <= now) {
+        Djuru *djuru = scheduler->sleeping[0].djuru;
+        // Queue it before taking it off the heap, so that it stays reachable
+        // if growing the queue collects garbage.
+        MSCScheduleReady(vm, djuru, NULL_VAL);
+        popSleeping(scheduler);
+    }
+}
+
+bool MSCSchedulePop(MVM *vm, ReadyDjuru *next) {
+    Scheduler *scheduler = &vm->scheduler;
+    if (scheduler->readyCount == 0) return false;
+
+    *next = scheduler->ready[scheduler->readyHead];
+    scheduler->readyHead = (scheduler->readyHead + 1) & (scheduler->readyCapacity - 1);
+    scheduler->readyCount--;
+    next->djuru->scheduled = false;
+    return true;
+}
+
+int MSCScheduleWaiting(MVM *vm) {
+    Scheduler *scheduler = &vm->scheduler;
+    return scheduler->readyCount + scheduler->sleepingCount +
+           scheduler->pendingCount + scheduler->pollingCount + scheduler->joining;
+}
+
+void MSCMarkScheduler(MVM *vm) {
+    Scheduler *scheduler = &vm->scheduler;
+    for (int i = 0; i < scheduler->readyCount; i++) {
+        ReadyDjuru *entry = &scheduler->ready[(scheduler->readyHead + i) & (scheduler->readyCapacity - 1)];
+        MSCGrayObject((Object *) entry->djuru, vm);
+        MSCGrayValue(vm, entry->value);
+    }
+    for (int i = 0; i < scheduler->sleepingCount; i++) {
+        MSCGrayObject((Object *) scheduler->sleeping[i].djuru, vm);
+    }
+    for (AsyncOp *op = scheduler->pending; op != NULL; op = op->nextPending) {
+        MSCGrayObject((Object *) op->djuru, vm);
+        MSCGrayValue(vm, op->keep);
+    }
+    for (PollWait *wait = scheduler->polling; wait != NULL; wait = wait->next) {
+        if (wait->reader != NULL) MSCGrayObject((Object *) wait->reader, vm);
+        if (wait->writer != NULL) MSCGrayObject((Object *) wait->writer, vm);
+    }
+}
+
+void MSCFreeScheduler(MVM *vm) {
+    Scheduler *scheduler = &vm->scheduler;
+
+#if MSC_OPT_THREADS
+    // Let the I/O threads finish what they are doing, then drop the
+    // operations that were not done.
+    AsyncThreads *threads = scheduler->threads;
+    if (threads != NULL) {
+        pthread_mutex_lock(&threads->lock);
+        threads->stopping = true;
+        pthread_cond_broadcast(&threads->queued);
+        pthread_mutex_unlock(&threads->lock);
+        for (int i = 0; i < threads->threadCount; i++) {
+            pthread_join(threads->threads[i], NULL);
+        }
+        pthread_cond_destroy(&threads->done);
+        pthread_cond_destroy(&threads->queued);
+        pthread_mutex_destroy(&threads->lock);
+        DEALLOCATE(vm, threads);
+        scheduler->threads = NULL;
+    }
+#endif
+    while (scheduler->pending != NULL) {
+        AsyncOp *op = scheduler->pending;
+        scheduler->pending = op->nextPending;
+        if (op->release != NULL) op->release(vm, op);
+        DEALLOCATE(vm, op);
+    }
+    scheduler->pendingCount = 0;
+
+    // The descriptors are closed by the objects owning them.
+    while (scheduler->polling != NULL) {
+        PollWait *wait = scheduler->polling;
+        wait->reader = wait->writer = NULL;
+        unlinkPolling(scheduler, wait);
+    }
+    scheduler->pollingCount = 0;
+#if MSC_OPT_POLL
+    if (scheduler->poller != NULL) {
+        close(scheduler->poller->wakeFd);
+        close(scheduler->poller->epollFd);
+        DEALLOCATE(vm, scheduler->poller);
+        scheduler->poller = NULL;
+    }
+#endif
+
+    // Events nobody will dispatch any more.
+    while (scheduler->posted != NULL) {
+        PostedEvent *event = scheduler->posted;
+        scheduler->posted = event->next;
+        vm->config.reallocateFn(event, 0, vm->config.userData);
+    }
+
+    DEALLOCATE(vm, scheduler->ready);
+    DEALLOCATE(vm, scheduler->sleeping);
+    scheduler->ready = NULL;
+    scheduler->sleeping = NULL;
+    scheduler->readyCount = scheduler->readyCapacity = 0;
+    scheduler->sleepingCount = scheduler->sleepingCapacity = 0;
+    scheduler->joining = 0;
+}
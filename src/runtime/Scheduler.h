@@ -0,0 +1,199 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#ifndef CPMSC_SCHEDULER_H
+#define CPMSC_SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "../memory/Value.h"
+
+#ifndef MSC_OPT_POLL
+#if defined(__linux__)
+#define MSC_OPT_POLL 1
+#else
+#define MSC_OPT_POLL 0
+#endif
+#endif
+
+// A djuru ready to run, and the value its suspended call returns when it
+// resumes. If [isError] is true, [value] is instead an error the djuru aborts
+// with.
+typedef struct {
+    Djuru *djuru;
+    Value value;
+    bool isError;
+} ReadyDjuru;
+
+typedef struct sAsyncOp AsyncOp;
+
+// Does the blocking part of [op] on an I/O thread. It must not touch the VM.
+typedef void (*MSCAsyncWorkFn)(AsyncOp *op);
+
+// Finishes [op] on the thread of the VM once its work is done, and returns the
+// value the waiting djuru's call returns. Sets [isError] to true to make the
+// djuru abort with the returned value instead.
+typedef Value (*MSCAsyncDoneFn)(MVM *vm, AsyncOp *op, bool *isError);
+
+// Releases what [op] holds outside of the VM, whether it completed or the VM
+// was freed first. May be NULL.
+typedef void (*MSCAsyncReleaseFn)(MVM *vm, AsyncOp *op);
+
+// A blocking operation a djuru waits for. Modules embed it at the start of a
+// larger struct holding the operation's own data.
+struct sAsyncOp {
+    // The djuru waiting for the operation.
+    Djuru *djuru;
+    // A value kept alive until the operation is done, like the buffer it
+    // reads into.
+    Value keep;
+
+    MSCAsyncWorkFn work;
+    MSCAsyncDoneFn done;
+    MSCAsyncReleaseFn release;
+
+    // The queue of the I/O threads the operation is in.
+    struct sAsyncOp *next;
+
+    // The operations that are not done yet, as seen from the thread of the VM.
+    struct sAsyncOp *prevPending;
+    struct sAsyncOp *nextPending;
+};
+
+typedef struct AsyncThreads AsyncThreads;
+
+// The djurus parked until a file descriptor is ready. Modules embed it in the
+// data of the object owning the descriptor, which the parked djurus keep alive.
+typedef struct sPollWait {
+    int fd;
+    // Whether [fd] is watched by the poller yet.
+    bool added;
+    // The djurus parked until [fd] can be read and written, or NULL.
+    Djuru *reader;
+    Djuru *writer;
+
+    struct sPollWait *prev;
+    struct sPollWait *next;
+} PollWait;
+
+typedef struct Poller Poller;
+
+// An event posted with [MSCPostEvent], waiting for the thread of the VM to
+// call the function held by [handle] with a copy of its bytes.
+typedef struct sPostedEvent {
+    MSCHandle *handle;
+    struct sPostedEvent *next;
+    size_t length;
+    uint8_t bytes[FLEXIBLE_ARRAY];
+} PostedEvent;
+
+// A djuru sleeping until [time], in milliseconds. [order] keeps the djurus
+// sleeping until the same time in the order they went to sleep.
+typedef struct {
+    double time;
+    uint64_t order;
+    Djuru *djuru;
+} SleepingDjuru;
+
+// The cooperative scheduler of a VM. Djurus wait in it to run, to wake up, or
+// for another djuru to finish, and [MSCRunScheduler] resumes them one at a
+// time on the thread of the VM.
+typedef struct {
+    // A ring buffer of the djurus ready to run, in the order they run.
+    ReadyDjuru *ready;
+    int readyHead;
+    int readyCount;
+    // Always a power of two.
+    int readyCapacity;
+
+    // A binary min-heap of the sleeping djurus, by time then order.
+    SleepingDjuru *sleeping;
+    int sleepingCount;
+    int sleepingCapacity;
+    uint64_t sleepingOrder;
+
+    // The number of djurus waiting for another one to finish.
+    int joining;
+
+    // The operations started with [MSCScheduleAsync] and not done yet.
+    AsyncOp *pending;
+    int pendingCount;
+    // The threads running them, started the first time one is.
+    AsyncThreads *threads;
+
+    // The descriptors djurus are parked on, how many djurus, and what watches
+    // the descriptors, made the first time one is.
+    PollWait *polling;
+    int pollingCount;
+    Poller *poller;
+
+    // The events posted and not dispatched yet, newest first. Other threads
+    // push to it without a lock, and the thread of the VM takes all of them
+    // at once.
+    PostedEvent *posted;
+
+    // Whether [MSCRunScheduler] is running a djuru.
+    bool running;
+} Scheduler;
+
+// The time of a clock that never goes back, in milliseconds.
+double MSCMonotonicMillis(void);
+
+// Adds [djuru] to the end of the ready queue. [value] is what its suspended
+// call returns when it resumes.
+void MSCScheduleReady(MVM *vm, Djuru *djuru, Value value);
+
+// Like [MSCScheduleReady], but the djuru aborts with [error] when it resumes.
+void MSCScheduleError(MVM *vm, Djuru *djuru, Value error);
+
+// Allocates an operation of [size] bytes, for the current djuru to wait for.
+AsyncOp *MSCNewAsyncOp(MVM *vm, size_t size, MSCAsyncWorkFn work,
+                       MSCAsyncDoneFn done, MSCAsyncReleaseFn release);
+
+// Runs the work of [op] on an I/O thread, or right away where there are no
+// threads. The djuru of [op] becomes ready once it is done, and must suspend
+// until then. The scheduler frees [op].
+void MSCScheduleAsync(MVM *vm, AsyncOp *op);
+
+// Parks the current djuru until the descriptor of [wait] can be read, or
+// written if [write] is true. Only one djuru may wait for each, and it must
+// suspend until then. Returns false, with errno set, if the descriptor cannot
+// be watched.
+bool MSCSchedulePoll(MVM *vm, PollWait *wait, bool write);
+
+// Stops watching the descriptor of [wait], before it is closed. The djurus
+// parked on it are made ready.
+void MSCScheduleUnpoll(MVM *vm, PollWait *wait);
+
+// Puts [djuru] to sleep for [ms] milliseconds.
+void MSCScheduleSleep(MVM *vm, Djuru *djuru, double ms);
+
+// Makes [waiter] wait until [djuru] is done.
+void MSCScheduleJoin(MVM *vm, Djuru *waiter, Djuru *djuru);
+
+// Makes the djurus waiting for [djuru] ready, with [result] as the value of
+// their wait. Called when [djuru] returns or aborts.
+void MSCWakeWaiters(MVM *vm, Djuru *djuru, Value result);
+
+// Moves the sleeping djurus whose time has come, the ones whose operation is
+// done and the ones whose descriptor is ready to the ready queue, and starts a
+// djuru for each posted event. If [wait] is true and no djuru is ready, first
+// blocks until one of them is.
+void MSCScheduleWake(MVM *vm, bool wait);
+
+// Takes the first ready djuru off the queue into [next]. Returns false if
+// there is none.
+bool MSCSchedulePop(MVM *vm, ReadyDjuru *next);
+
+// The number of djurus ready, sleeping, waiting for an operation, a descriptor
+// or another djuru.
+int MSCScheduleWaiting(MVM *vm);
+
+// Marks the djurus held by the scheduler.
+void MSCMarkScheduler(MVM *vm);
+
+// Frees the memory used by the scheduler.
+void MSCFreeScheduler(MVM *vm);
+
+#endif //CPMSC_SCHEDULER_H
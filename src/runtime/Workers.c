@@ -0,0 +1,146 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#include "Workers.h"
+#include "MVM.h"
+
+#if MSC_OPT_THREADS
+
+#include <pthread.h>
+
+struct Workers {
+    pthread_mutex_t lock;
+    // Signaled when a job is posted or the workers must stop.
+    pthread_cond_t wake;
+    // Signaled when the last piece of a job is done.
+    pthread_cond_t done;
+
+    MSCTaskFn task;
+    void *data;
+    // The next piece to hand out, the number of pieces, and how many have not
+    // finished yet.
+    int next;
+    int count;
+    int pending;
+    bool stopping;
+
+    int threadCount;
+    pthread_t threads[FLEXIBLE_ARRAY];
+};
+
+// Takes and runs pieces of the current job until there are none left. Called
+// and returns with [workers->lock] held.
+static void runPieces(Workers *workers) {
+    while (workers->next < workers->count) {
+        int index = workers->next++;
+        pthread_mutex_unlock(&workers->lock);
+        workers->task(workers->data, index);
+        pthread_mutex_lock(&workers->lock);
+        if (--workers->pending == 0) pthread_cond_signal(&workers->done);
+    }
+}
+
+static void *workerMain(void *arg) {
+    Workers *workers = (Workers *) arg;
+    pthread_mutex_lock(&workers->lock);
+    while (!workers->stopping) {
+        runPieces(workers);
+        if (!workers->stopping) pthread_cond_wait(&workers->wake, &workers->lock);
+    }
+    pthread_mutex_unlock(&workers->lock);
+    return NULL;
+}
+
+Workers *MSCGetWorkers(MVM *vm) {
+    if (vm->workers != NULL || vm->config.workerThreads <= 0) return vm->workers;
+
+    int threadCount = vm->config.workerThreads;
+    Workers *workers = ALLOCATE_FLEX(vm, Workers, pthread_t, threadCount);
+    pthread_mutex_init(&workers->lock, NULL);
+    pthread_cond_init(&workers->wake, NULL);
+    pthread_cond_init(&workers->done, NULL);
+    workers->task = NULL;
+    workers->data = NULL;
+    workers->next = workers->count = workers->pending = 0;
+    workers->stopping = false;
+    workers->threadCount = 0;
+
+    // Keep whatever threads could be started.
+    for (int i = 0; i < threadCount; i++) {
+        if (pthread_create(&workers->threads[i], NULL, workerMain, workers) != 0) break;
+        workers->threadCount++;
+    }
+
+    vm->workers = workers;
+    return workers;
+}
+
+void MSCFreeWorkers(MVM *vm) {
+    Workers *workers = vm->workers;
+    if (workers == NULL) return;
+
+    pthread_mutex_lock(&workers->lock);
+    workers->stopping = true;
+    pthread_cond_broadcast(&workers->wake);
+    pthread_mutex_unlock(&workers->lock);
+    for (int i = 0; i < workers->threadCount; i++) {
+        pthread_join(workers->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&workers->done);
+    pthread_cond_destroy(&workers->wake);
+    pthread_mutex_destroy(&workers->lock);
+    DEALLOCATE(vm, workers);
+    vm->workers = NULL;
+}
+
+int MSCWorkersThreadCount(Workers *workers) {
+    return workers == NULL ? 1 : workers->threadCount + 1;
+}
+
+void MSCWorkersRun(Workers *workers, MSCTaskFn task, void *data, int count) {
+    if (workers == NULL || workers->threadCount == 0 || count < 2) {
+        for (int i = 0; i < count; i++) task(data, i);
+        return;
+    }
+
+    pthread_mutex_lock(&workers->lock);
+    workers->task = task;
+    workers->data = data;
+    workers->next = 0;
+    workers->count = count;
+    workers->pending = count;
+    pthread_cond_broadcast(&workers->wake);
+
+    // The calling thread takes pieces too, then waits for the ones still
+    // running.
+    runPieces(workers);
+    while (workers->pending > 0) pthread_cond_wait(&workers->done, &workers->lock);
+    workers->task = NULL;
+    workers->data = NULL;
+    pthread_mutex_unlock(&workers->lock);
+}
+
+#else
+
+Workers *MSCGetWorkers(MVM *vm) {
+    (void) vm;
+    return NULL;
+}
+
+void MSCFreeWorkers(MVM *vm) {
+    (void) vm;
+}
+
+int MSCWorkersThreadCount(Workers *workers) {
+    (void) workers;
+    return 1;
+}
+
+void MSCWorkersRun(Workers *workers, MSCTaskFn task, void *data, int count) {
+    (void) workers;
+    for (int i = 0; i < count; i++) task(data, i);
+}
+
+#endif
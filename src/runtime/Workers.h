@@ -0,0 +1,43 @@
+//
+// Created by Mahamadou DOUMBIA [OML DSI] on 18/10/2026.
+//
+
+#ifndef CPMSC_WORKERS_H
+#define CPMSC_WORKERS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "../api/msc.h"
+
+#ifndef MSC_OPT_THREADS
+#if defined(__EMSCRIPTEN__) || defined(_WIN32)
+#define MSC_OPT_THREADS 0
+#else
+#define MSC_OPT_THREADS 1
+#endif
+#endif
+
+// A pool of worker threads owned by a VM. It only runs pure C kernels, such as
+// sorting a list of numbers, that neither allocate nor touch the interpreter,
+// while the thread that owns the VM waits for them.
+typedef struct Workers Workers;
+
+// Runs one of the [count] pieces of a job. [index] is in [0, count).
+typedef void (*MSCTaskFn)(void *data, int index);
+
+// Returns the workers of [vm], starting them the first time, or NULL when
+// [MSCConfig.workerThreads] is zero or threads are not available.
+Workers *MSCGetWorkers(MVM *vm);
+
+// Stops and frees the workers of [vm], if they were started.
+void MSCFreeWorkers(MVM *vm);
+
+// The number of threads that run a job, counting the calling one.
+int MSCWorkersThreadCount(Workers *workers);
+
+// Runs [task] for each index in [0, count) on the workers and the calling
+// thread, and returns once all of them are done. With no [workers], runs them
+// in order on the calling thread.
+void MSCWorkersRun(Workers *workers, MSCTaskFn task, void *data, int count);
+
+#endif //CPMSC_WORKERS_H
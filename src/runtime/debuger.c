@@ -186,6 +186,51 @@ static int dumpInstruction(MVM *vm, Function *fn, int i, int *lastLine) {
             break;
         }
 
+        case OP_FOR_ITER: {
+            int slot = READ_BYTE();
+            int iterateSymbol = READ_SHORT();
+            int valueSymbol = READ_SHORT();
+            int toTest = READ_SHORT();
+            int toBody = READ_SHORT();
+            printf("%-16s %5d '%s' '%s' test %d body %d\n", "FOR_ITER", slot,
+                   vm->methodNames.data[iterateSymbol]->value,
+                   vm->methodNames.data[valueSymbol]->value, i + toTest, i + toBody);
+            break;
+        }
+
+        case OP_TO_STRING: {
+            int symbol = READ_SHORT();
+            printf("%-16s %5d '%s'\n", "TO_STRING", symbol,
+                   vm->methodNames.data[symbol]->value);
+            break;
+        }
+
+        case OP_INTERPOLATE:
+            BYTE_INSTRUCTION("INTERPOLATE");
+
+        case OP_FOR_RANGE_INIT: {
+            int slot = READ_BYTE();
+            int symbol = READ_SHORT();
+            int iterateSymbol = READ_SHORT();
+            int valueSymbol = READ_SHORT();
+            int offset = READ_SHORT();
+            printf("%-16s %5d '%s' '%s' '%s' to %d\n", "FOR_RANGE_INIT", slot,
+                   vm->methodNames.data[symbol]->value,
+                   vm->methodNames.data[iterateSymbol]->value,
+                   vm->methodNames.data[valueSymbol]->value, i + offset);
+            break;
+        }
+
+        case OP_FOR_RANGE: {
+            int slot = READ_BYTE();
+            int isInclusive = READ_BYTE();
+            int toTest = READ_SHORT();
+            int toBody = READ_SHORT();
+            printf("%-16s %5d %s test %d body %d\n", "FOR_RANGE", slot,
+                   isInclusive ? ".." : "...", i + toTest, i + toBody);
+            break;
+        }
+
         case OP_AND: {
             int offset = READ_SHORT();
             printf("%-16s %5d to %d\n", "AND", offset, i + offset);
@@ -204,6 +249,15 @@ static int dumpInstruction(MVM *vm, Function *fn, int i, int *lastLine) {
         case OP_RETURN:
             printf("RETURN\n");
             break;
+        case OP_GENERATOR:
+            printf("GENERATOR\n");
+            break;
+        case OP_YIELD:
+            printf("YIELD\n");
+            break;
+        case OP_GENERATOR_END:
+            printf("GENERATOR_END\n");
+            break;
 
         case OP_CLOSURE: {
             int constant = READ_SHORT();
@@ -362,6 +416,24 @@ void MSCDumpObject(Object *obj) {
         case OBJ_RANGE:
             printf("[range(%f, %f) %p]", ((Range *) obj)->from, ((Range *) obj)->to, obj);
             break;
+        case OBJ_SET:
+            printf("[set %p]", obj);
+            break;
+        case OBJ_TYPED_ARRAY:
+            printf("[typed array %p]", obj);
+            break;
+        case OBJ_DEQUE:
+            printf("[deque %p]", obj);
+            break;
+        case OBJ_HEAP:
+            printf("[heap %p]", obj);
+            break;
+        case OBJ_CHANNEL:
+            printf("[channel %p]", obj);
+            break;
+        case OBJ_GENERATOR:
+            printf("[generator %p]", obj);
+            break;
         case OBJ_STRING:
             printf("%s", ((String *) obj)->value);
             break;
@@ -377,7 +449,9 @@ void MSCDumpObject(Object *obj) {
 void MSCDumpValue(Value value) {
 #if MSC_NAN_TAGGING
     if (IS_NUM(value)) {
-        printf("%.14g", AS_NUM(value));
+        char buffer[MSC_NUM_CHARS];
+        MSCNumToChars(AS_NUM(value), buffer);
+        printf("%s", buffer);
     } else if (IS_OBJ(value)) {
         MSCDumpObject(AS_OBJ(value));
     } else {
@@ -403,7 +477,13 @@ void MSCDumpValue(Value value) {
     {
         case VAL_FALSE:     printf("false"); break;
         case VAL_NULL:      printf("null"); break;
-        case VAL_NUM:       printf("%.14g", AS_NUM(value)); break;
+        case VAL_NUM:
+        {
+            char buffer[MSC_NUM_CHARS];
+            MSCNumToChars(AS_NUM(value), buffer);
+            printf("%s", buffer);
+            break;
+        }
         case VAL_TRUE:      printf("true"); break;
         case VAL_OBJ:       MSCDumpObject(AS_OBJ(value)); break;
         case VAL_UNDEFINED: UNREACHABLE();
@@ -0,0 +1,65 @@
+// Helpers shared by the tests of the embedding API. Each test is a program
+// that exits with a non-zero status if one of its checks fails, and is run by
+// ctest.
+
+#ifndef CPMSC_TEST_API_H
+#define CPMSC_TEST_API_H
+
+#include <string.h>
+#include "../../src/api/msc.h"
+
+// What the scripts printed since the last [expectOutput], followed by the
+// runtime errors they reported, one per line.
+static char output[4096];
+static int failures = 0;
+
+static void append(const char *text) {
+    strncat(output, text, sizeof(output) - strlen(output) - 1);
+}
+
+static void writeOutput(MVM *vm, const char *text) {
+    (void) vm;
+    append(text);
+}
+
+static bool reportError(MVM *vm, MSCError type, const char *module, int line, const char *message) {
+    (void) vm;
+    (void) module;
+    (void) line;
+    if (type == ERROR_COMPILE || type == ERROR_RUNTIME) {
+        append("error: ");
+        append(message);
+        append("\n");
+    }
+    return true;
+}
+
+#define EXPECT(condition)                                                      \
+    do                                                                         \
+    {                                                                          \
+      if (!(condition)) {                                                      \
+        fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__, #condition); \
+        failures++;                                                            \
+      }                                                                        \
+    } while (false)
+
+// Checks what was printed since the last call, and starts over.
+#define EXPECT_OUTPUT(expected)                                                \
+    do                                                                         \
+    {                                                                          \
+      if (strcmp(output, expected) != 0) {                                     \
+        fprintf(stderr, "%s:%d: expected output:\n%s\ngot:\n%s\n", __FILE__,    \
+                __LINE__, expected, output);                                   \
+        failures++;                                                            \
+      }                                                                        \
+      output[0] = '\0';                                                        \
+    } while (false)
+
+// Fills [config] with the defaults, printing through the helpers above.
+static void initTestConfig(MSCConfig *config) {
+    MSCInitConfig(config);
+    config->writeFn = writeOutput;
+    config->errorHandler = reportError;
+}
+
+#endif //CPMSC_TEST_API_H
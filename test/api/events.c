@@ -0,0 +1,103 @@
+// Tests MSCPostEvent: events posted from other threads while the scheduler
+// runs, and the handles it refuses.
+
+#include <pthread.h>
+#include <time.h>
+#include "api.h"
+
+#define POSTERS 4
+#define EVENTS_PER_POSTER 20000
+
+static MVM *vm;
+static MSCHandle *onEvent;
+
+static MSCHandle *getHandle(const char *name) {
+    MSCEnsureSlots(vm, 1);
+    MSCGetVariable(vm, "main", name, 0);
+    return MSCGetSlotHandle(vm, 0);
+}
+
+static double getNumber(const char *name) {
+    MSCEnsureSlots(vm, 1);
+    MSCGetVariable(vm, "main", name, 0);
+    return MSCGetSlotDouble(vm, 0);
+}
+
+static void sleepMillis(long milliseconds) {
+    struct timespec time = {milliseconds / 1000, (milliseconds % 1000) * 1000000};
+    nanosleep(&time, NULL);
+}
+
+// Posts [poster]'s index and a counter wrapping at 256 in each event.
+static void *post(void *poster) {
+    for (int i = 0; i < EVENTS_PER_POSTER; i++) {
+        unsigned char bytes[2] = {(unsigned char) (long) poster, (unsigned char) i};
+        while (!MSCPostEvent(vm, onEvent, bytes, sizeof(bytes))) {}
+    }
+    return NULL;
+}
+
+static void *postLate(void *unused) {
+    (void) unused;
+    sleepMillis(50);
+    MSCPostEvent(vm, onEvent, "late", 4);
+    return NULL;
+}
+
+int main(void) {
+    MSCConfig config;
+    initTestConfig(&config);
+    vm = MSCNewVM(&config);
+
+    MSCInterpret(vm, "main",
+                 "nin count = 0\n"
+                 "nin ordered = tien\n"
+                 "nin last = [255, 255, 255, 255]\n"
+                 "nin onEvent = Tii.kura {(bytes) =>\n"
+                 "    nii (bytes.hakan == 2) {\n"
+                 "        count = count + 1\n"
+                 "        nii (bytes[1] != (last[bytes[0]] + 1) % 256) {\n"
+                 "            ordered = galon\n"
+                 "        }\n"
+                 "        last[bytes[0]] = bytes[1]\n"
+                 "    } note {\n"
+                 "        A.yira(\"event ${bytes.hakan}\")\n"
+                 "    }\n"
+                 "}\n"
+                 "nin notAFunction = 1\n"
+                 "nin twoParameters = Tii.kura {(a, b) => a }\n");
+    onEvent = getHandle("onEvent");
+
+    // Only functions taking at most one parameter are accepted.
+    MSCHandle *number = getHandle("notAFunction");
+    MSCHandle *binary = getHandle("twoParameters");
+    EXPECT(!MSCPostEvent(vm, number, "x", 1));
+    EXPECT(!MSCPostEvent(vm, binary, "x", 1));
+    MSCReleaseHandle(vm, number);
+    MSCReleaseHandle(vm, binary);
+
+    // Events from each thread are handled in the order they were posted.
+    pthread_t posters[POSTERS];
+    for (long i = 0; i < POSTERS; i++) pthread_create(&posters[i], NULL, post, (void *) i);
+    while (getNumber("count") < POSTERS * EVENTS_PER_POSTER) MSCRunScheduler(vm, 0);
+    for (int i = 0; i < POSTERS; i++) pthread_join(posters[i], NULL);
+    EXPECT(getNumber("count") == POSTERS * EVENTS_PER_POSTER);
+    MSCInterpret(vm, "main", "A.yira(ordered)\n");
+    EXPECT_OUTPUT("tien\n");
+
+    // A scheduler waiting for a sleeping djuru is woken up by a post.
+    pthread_t late;
+    pthread_create(&late, NULL, postLate, NULL);
+    MSCInterpret(vm, "main",
+                 "Djuru.bila {\n"
+                 "    Djuru.sunogo(500)\n"
+                 "    A.yira(\"woke\")\n"
+                 "}\n");
+    EXPECT(MSCRunScheduler(vm, 0) == 0);
+    pthread_join(late, NULL);
+    EXPECT_OUTPUT("event 4\nwoke\n");
+
+    MSCReleaseHandle(vm, onEvent);
+    MSCFreeVM(vm);
+    return failures == 0 ? 0 : 1;
+}
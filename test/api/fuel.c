@@ -0,0 +1,78 @@
+// Tests MSCSetFuel, both aborting a script that runs out and suspending it
+// until the host gives it more.
+
+#include "api.h"
+
+static const char *endless =
+        "nin i = 0\n"
+        "foo (tien) {\n"
+        "    i = i + 1\n"
+        "}\n";
+
+// Runs [endless] in new VMs with the same fuel, and checks that it stops at the
+// same point each time.
+static void checkOutOfFuel(MSCConfig *config) {
+    for (int run = 0; run < 2; run++) {
+        MVM *vm = MSCNewVM(config);
+        EXPECT(MSCGetFuel(vm) == -1);
+        MSCSetFuel(vm, 1000);
+        EXPECT(MSCInterpret(vm, "main", endless) == RESULT_RUNTIME_ERROR);
+        EXPECT(MSCGetFuel(vm) == 0);
+        EXPECT_OUTPUT("error: Out of fuel.\n");
+
+        MSCSetFuel(vm, -1);
+        EXPECT(MSCGetFuel(vm) == -1);
+        // The body runs once more than the 1000 back-edges the fuel pays for.
+        EXPECT(MSCInterpret(vm, "main", "A.yira(i)\n") == RESULT_SUCCESS);
+        EXPECT_OUTPUT("1001\n");
+        MSCFreeVM(vm);
+    }
+}
+
+int main(void) {
+    MSCConfig config;
+    initTestConfig(&config);
+    checkOutOfFuel(&config);
+
+    // A suspended script goes on in the scheduler, a slice of fuel at a time.
+    config.fuelSuspends = true;
+    MVM *vm = MSCNewVM(&config);
+    MSCSetFuel(vm, 100);
+    EXPECT(MSCInterpret(vm, "main",
+                        "nin total = 0\n"
+                        "Djuru.bila {\n"
+                        "    nin i = 0\n"
+                        "    foo (i < 1000) {\n"
+                        "        total = total + 1\n"
+                        "        i = i + 1\n"
+                        "    }\n"
+                        "    A.yira(\"djuru\")\n"
+                        "}\n"
+                        "nin k = 0\n"
+                        "foo (k < 1000) {\n"
+                        "    total = total + 1\n"
+                        "    k = k + 1\n"
+                        "}\n"
+                        "A.yira(\"main\")\n") == RESULT_SUSPENDED);
+
+    // Without fuel, the scheduler leaves the djurus waiting.
+    EXPECT(MSCRunScheduler(vm, 0) > 0);
+    EXPECT_OUTPUT("");
+
+    int slices = 0;
+    int waiting;
+    do {
+        MSCSetFuel(vm, 100);
+        waiting = MSCRunScheduler(vm, 0);
+        slices++;
+    } while (waiting > 0 && slices < 1000);
+    EXPECT(waiting == 0);
+    EXPECT(slices > 10);
+    EXPECT_OUTPUT("main\ndjuru\n");
+
+    MSCSetFuel(vm, -1);
+    EXPECT(MSCInterpret(vm, "main", "A.yira(total)\n") == RESULT_SUCCESS);
+    EXPECT_OUTPUT("2000\n");
+    MSCFreeVM(vm);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+// Tests MSCInterrupt and MSCSetTimeout on scripts that would otherwise never
+// return.
+
+#include <pthread.h>
+#include <time.h>
+#include "api.h"
+
+static MVM *vm;
+
+static void *interruptLater(void *unused) {
+    (void) unused;
+    struct timespec time = {0, 50 * 1000000};
+    nanosleep(&time, NULL);
+    MSCInterrupt(vm);
+    return NULL;
+}
+
+// Runs [source] while another thread interrupts it.
+static MSCInterpretResult interpretInterrupted(const char *source) {
+    pthread_t thread;
+    pthread_create(&thread, NULL, interruptLater, NULL);
+    MSCInterpretResult result = MSCInterpret(vm, "main", source);
+    pthread_join(thread, NULL);
+    return result;
+}
+
+int main(void) {
+    MSCConfig config;
+    initTestConfig(&config);
+    vm = MSCNewVM(&config);
+
+    EXPECT(interpretInterrupted("foo (tien) {\n}\n") == RESULT_RUNTIME_ERROR);
+    EXPECT_OUTPUT("error: Djuru was interrupted.\n");
+
+    // The interruption can be caught, and only happens once.
+    EXPECT(interpretInterrupted("ake {\n"
+                                "    foo (tien) {\n"
+                                "    }\n"
+                                "} namason (e) {\n"
+                                "    A.yira(e)\n"
+                                "}\n"
+                                "A.yira(\"after\")\n") == RESULT_SUCCESS);
+    EXPECT_OUTPUT("Djuru was interrupted.\nafter\n");
+
+    // Without a running script, the next one is interrupted.
+    MSCInterrupt(vm);
+    EXPECT(MSCInterpret(vm, "main", "foo (tien) {\n}\n") == RESULT_RUNTIME_ERROR);
+    EXPECT_OUTPUT("error: Djuru was interrupted.\n");
+
+    MSCSetTimeout(vm, 30);
+    EXPECT(MSCInterpret(vm, "main", "foo (tien) {\n}\n") == RESULT_RUNTIME_ERROR);
+    EXPECT_OUTPUT("error: Deadline exceeded.\n");
+
+    // A passed deadline aborts again at each safe point, so catching it does
+    // not keep the script running.
+    EXPECT(MSCInterpret(vm, "main",
+                        "foo (tien) {\n"
+                        "    ake {\n"
+                        "        foo (tien) {\n"
+                        "        }\n"
+                        "    } namason (e) {\n"
+                        "    }\n"
+                        "}\n") == RESULT_RUNTIME_ERROR);
+    EXPECT_OUTPUT("error: Deadline exceeded.\n");
+
+    // Each call gets the whole timeout.
+    EXPECT(MSCInterpret(vm, "main", "A.yira(\"in time\")\n") == RESULT_SUCCESS);
+    EXPECT_OUTPUT("in time\n");
+
+    MSCSetTimeout(vm, 0);
+    EXPECT(MSCInterpret(vm, "main",
+                        "nin i = 0\n"
+                        "foo (i < 1000000) {\n"
+                        "    i = i + 1\n"
+                        "}\n"
+                        "A.yira(i)\n") == RESULT_SUCCESS);
+    EXPECT_OUTPUT("1000000\n");
+
+    MSCFreeVM(vm);
+    return failures == 0 ? 0 : 1;
+}
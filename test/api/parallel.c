@@ -0,0 +1,81 @@
+// Tests the list kernels split between the worker threads: the default sort
+// and the sum, smallest and largest element give the same results as on a
+// single thread.
+
+#include <stdlib.h>
+#include "api.h"
+
+// Builds lists of pseudo-random numbers and strings, sorts them, and keeps a
+// report of the results in [report]. The sizes cover a list under the
+// threshold, one whose last piece has no block to reduce, and one spanning
+// many blocks.
+static const char *source =
+        "nin seed = 1\n"
+        "tii next() {\n"
+        "    seed = (seed * 16807) % 2147483647\n"
+        "    segin niin seed % 100000\n"
+        "}\n"
+        "tii numbers(count) {\n"
+        "    nin list = []\n"
+        "    foo (list.hakan < count) {\n"
+        "        list.aFaraAkan(next())\n"
+        "    }\n"
+        "    segin niin list\n"
+        "}\n"
+        "tii strings(count) {\n"
+        "    nin list = []\n"
+        "    foo (list.hakan < count) {\n"
+        "        list.aFaraAkan(\"s${next()}\")\n"
+        "    }\n"
+        "    segin niin list\n"
+        "}\n"
+        "tii sorted(list) {\n"
+        "    nin copy = []\n"
+        "    copy.aBeeFaraAkan(list)\n"
+        "    segin niin copy.woloma()\n"
+        "}\n"
+        "nin report = \"\"\n"
+        "nin sameAsComparer = tien\n"
+        "seginka [500, 16385, 50000] kono count {\n"
+        "    nin list = numbers(count)\n"
+        "    nin byComparer = []\n"
+        "    byComparer.aBeeFaraAkan(list)\n"
+        "    byComparer.woloma {(low, high) => low < high }\n"
+        "    nin text = sorted(list).kunBen(\",\")\n"
+        "    nii (text != byComparer.kunBen(\",\")) {\n"
+        "        sameAsComparer = galon\n"
+        "    }\n"
+        "    report = report + \"${list.fara} ${list.min} ${list.max} ${text}\\n\"\n"
+        "    list = strings(count)\n"
+        "    report = report + \"${list.min} ${list.max} ${sorted(list).kunBen(\",\")}\\n\"\n"
+        "}\n";
+
+// Runs [source] in a new VM with [workerThreads], and returns a copy of its
+// report.
+static char *runReport(int workerThreads) {
+    MSCConfig config;
+    initTestConfig(&config);
+    config.workerThreads = workerThreads;
+    config.parallelThreshold = 1000;
+    MVM *vm = MSCNewVM(&config);
+    EXPECT(MSCInterpret(vm, "main", source) == RESULT_SUCCESS);
+    EXPECT_OUTPUT("");
+
+    MSCEnsureSlots(vm, 1);
+    MSCGetVariable(vm, "main", "sameAsComparer", 0);
+    EXPECT(MSCGetSlotBool(vm, 0));
+    MSCGetVariable(vm, "main", "report", 0);
+    char *report = strdup(MSCGetSlotString(vm, 0));
+    MSCFreeVM(vm);
+    return report;
+}
+
+int main(void) {
+    char *single = runReport(0);
+    char *parallel = runReport(3);
+    EXPECT(strlen(single) > 0);
+    EXPECT(strcmp(single, parallel) == 0);
+    free(single);
+    free(parallel);
+    return failures == 0 ? 0 : 1;
+}
@@ -46,7 +46,10 @@ int main() {
     config.writeFn = print;
 
     MVM *vm = MSCNewVM(&config);
-    MSCInterpret(vm, "script", text);
+    if (MSCInterpret(vm, "script", text) == RESULT_SUCCESS) {
+        // Run the djurus the script left sleeping or waiting.
+        MSCRunScheduler(vm, 0);
+    }
     MSCFreeVM(vm);
     free((void *) text);
     return 0;